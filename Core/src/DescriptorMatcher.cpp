@@ -0,0 +1,137 @@
+/*
+ * This file is part of ElasticFusion.
+ *
+ * Copyright (C) 2015 Imperial College London
+ * 
+ * The use of the code within this file and all code within files that 
+ * make up the software that is ElasticFusion is permitted for 
+ * non-commercial purposes only.  The full terms and conditions that 
+ * apply to the code within this file are detailed within the LICENSE.txt 
+ * file and at <http://www.imperial.ac.uk/dyson-robotics-lab/downloads/elastic-fusion/elastic-fusion-license/> 
+ * unless explicitly stated.  By downloading this file you agree to 
+ * comply with these terms.
+ *
+ * If you wish to use any of this code for commercial purposes then 
+ * please email researchcontracts.engineering@imperial.ac.uk.
+ *
+ */
+
+#include "DescriptorMatcher.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "Utils/Parallel.h"
+#include "Utils/SSEMath.h"
+
+#ifdef __SSE2__
+//Set bits of every four bit mask
+static const int bitCount[16] = {0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4};
+#endif
+
+DescriptorMatcher::DescriptorMatcher(const float tolerance, const int minScore, const unsigned int numThreads)
+ : tolerance(tolerance),
+   minScore(minScore),
+   numThreads(Parallel::threadCount(numThreads)),
+   k(0)
+{
+
+}
+
+bool DescriptorMatcher::setTemplates(const ObjectLibrary & library)
+{
+    if(library.size() > 0 && library.dimensions() == width)
+    {
+        setTemplates(library.descriptor(0), library.size());
+        return true;
+    }
+
+    templates.clear();
+
+    return library.size() == 0;
+}
+
+void DescriptorMatcher::setTemplates(const float * descriptors, const size_t count)
+{
+    templates.assign(descriptors, descriptors + count * width);
+}
+
+void DescriptorMatcher::match(const float * descriptors, const size_t count, const int dimensions, const int k)
+{
+    this->k = std::max(k, 1);
+
+    const Match none = {-1, 0};
+    results.assign(count * this->k, none);
+
+    const int numCuts = dimensions / width;
+    const int numTemplates = (int)this->numTemplates();
+
+    if(numCuts == 0 || numTemplates == 0)
+    {
+        return;
+    }
+
+    Parallel::forRange(0, count, numThreads, [&](const size_t begin, const size_t end, const unsigned int)
+    {
+#ifdef __SSE2__
+        const __m128 limit = _mm_set1_ps(tolerance);
+#endif
+
+        for(size_t segment = begin; segment < end; segment++)
+        {
+            const float * descriptor = &descriptors[segment * dimensions];
+            Match * best = &results[segment * this->k];
+
+            for(int t = 0; t < numTemplates; t++)
+            {
+                const float * object = &templates[t * width];
+
+#ifdef __SSE2__
+                const __m128 low = _mm_loadu_ps(object);
+                const __m128 high = _mm_loadu_ps(object + 4);
+#endif
+
+                int score = 0;
+
+                for(int cut = 0; cut < numCuts && score < width; cut++)
+                {
+                    const float * values = &descriptor[cut * width];
+
+                    //NaN compares false, so it never counts
+#ifdef __SSE2__
+                    const int lowMask = _mm_movemask_ps(_mm_cmplt_ps(SSEMath::abs(_mm_sub_ps(_mm_loadu_ps(values), low)), limit));
+                    const int highMask = _mm_movemask_ps(_mm_cmplt_ps(SSEMath::abs(_mm_sub_ps(_mm_loadu_ps(values + 4), high)), limit));
+
+                    score = std::max(score, bitCount[lowMask] + bitCount[highMask]);
+#else
+                    int cutScore = 0;
+
+                    for(int j = 0; j < width; j++)
+                    {
+                        cutScore += std::fabs(values[j] - object[j]) < tolerance;
+                    }
+
+                    score = std::max(score, cutScore);
+#endif
+                }
+
+                if(score < minScore || score <= best[this->k - 1].score)
+                {
+                    continue;
+                }
+
+                //Templates come in increasing order, so equal scores stay ahead
+                int slot = this->k - 1;
+
+                while(slot > 0 && best[slot - 1].score < score)
+                {
+                    best[slot] = best[slot - 1];
+                    slot--;
+                }
+
+                best[slot].object = t;
+                best[slot].score = score;
+            }
+        }
+    }, 16);
+}
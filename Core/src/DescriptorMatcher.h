@@ -0,0 +1,82 @@
+/*
+ * This file is part of ElasticFusion.
+ *
+ * Copyright (C) 2015 Imperial College London
+ * 
+ * The use of the code within this file and all code within files that 
+ * make up the software that is ElasticFusion is permitted for 
+ * non-commercial purposes only.  The full terms and conditions that 
+ * apply to the code within this file are detailed within the LICENSE.txt 
+ * file and at <http://www.imperial.ac.uk/dyson-robotics-lab/downloads/elastic-fusion/elastic-fusion-license/> 
+ * unless explicitly stated.  By downloading this file you agree to 
+ * comply with these terms.
+ *
+ * If you wish to use any of this code for commercial purposes then 
+ * please email researchcontracts.engineering@imperial.ac.uk.
+ *
+ */
+
+#ifndef DESCRIPTORMATCHER_H_
+#define DESCRIPTORMATCHER_H_
+
+#include <vector>
+
+#include "ObjectLibrary.h"
+
+/**
+ * Matches slice angle descriptors against every template of the object library. A segment scores, per template,
+ * the most values of any of its cuts lying within tolerance of the template, the count the recognition always used.
+ * That count is no metric, so rather than a tree that could not prune it exactly the templates are packed side by side
+ * and every cut is compared with a whole template in two SSE comparisons and a mask lookup (a scalar loop without SSE2).
+ */
+class DescriptorMatcher
+{
+    public:
+        class Match
+        {
+            public:
+                //Index in the library, -1 for no match
+                int object;
+                int score;
+        };
+
+        static const int width = 8;
+
+        DescriptorMatcher(const float tolerance = 15.0f, const int minScore = 5, const unsigned int numThreads = 0);
+
+        /**
+         * Copies the templates of a library of width wide descriptors, a library of any other width leaves none
+         * @return false if the library has descriptors but not of width values
+         */
+        bool setTemplates(const ObjectLibrary & library);
+
+        void setTemplates(const float * descriptors, const size_t count);
+
+        /**
+         * Keeps the k best templates scoring at least minScore of every segment, best first and ties to the lower index
+         * @param descriptors count descriptors of dimensions floats, a multiple of width
+         */
+        void match(const float * descriptors, const size_t count, const int dimensions, const int k);
+
+        size_t numTemplates() const
+        {
+            return templates.size() / width;
+        }
+
+        const Match * matches(const size_t segment) const
+        {
+            return &results[segment * k];
+        }
+
+    private:
+        const float tolerance;
+        const int minScore;
+        const unsigned int numThreads;
+
+        std::vector<float> templates;
+
+        int k;
+        std::vector<Match> results;
+};
+
+#endif /* DESCRIPTORMATCHER_H_ */
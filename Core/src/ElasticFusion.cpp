@@ -75,6 +75,7 @@ ElasticFusion::ElasticFusion(const int timeDelta,
       reloc(reloc),
       lost(false),
       lastFrameRecovery(false),
+      lastFrameNovel(false),
       trackingCount(0),
       maxDepthProcessed(20.0f),
       rgbOnly(false),
@@ -88,9 +89,20 @@ ElasticFusion::ElasticFusion(const int timeDelta,
       depthCutoff(depthCut),
       find_target(false),
       target_change(false),
-      label_count(0)
+      label_count(0),
+      frameCloud(Resolution::getInstance().width(), Resolution::getInstance().height()),
+      objectLibrary(SliceDescriptors::version)
     // cloud( new pcl::PointCloud<pcl::PointXYZRGB> )//--------new add
 {
+    //Descriptors for the recognition, a binary catalogue if there is one, otherwise the single descriptor in up.txt
+    if(!objectLibrary.load("objects.efol") && !objectLibrary.importText("up.txt", "up"))
+    {
+        std::cout << "No object descriptors of version " << SliceDescriptors::version << " in objects.efol or up.txt, recognition is off" << std::endl;
+    }
+
+    //The templates are packed once here and on reloadObjects, not every frame
+    setObjectTemplates();
+
     createTextures();
     createCompute();
     createFeedbackBuffers();
@@ -274,6 +286,26 @@ bool ElasticFusion::denseEnough(const Img<Eigen::Matrix<unsigned char, 3, 1>> &
     return float(sum) / float(img.rows * img.cols) > 0.75f;
 }
 
+void ElasticFusion::segmentCloud(const size_t segment, pcl::PointCloud<pcl::PointXYZLNormal> & cloud) const
+{
+    cloud.points.resize(surfelSegments.count(segment));
+
+    for(uint32_t i = surfelSegments.begin(segment); i < surfelSegments.end(segment); i++)
+    {
+        pcl::PointXYZLNormal & p = cloud.points[i - surfelSegments.begin(segment)];
+        p.x = surfelSegments.x[i];
+        p.y = surfelSegments.y[i];
+        p.z = surfelSegments.z[i];
+        p.label = surfelSegments.label(segment);
+        p.normal_x = surfelSegments.nx[i];
+        p.normal_y = surfelSegments.ny[i];
+        p.normal_z = surfelSegments.nz[i];
+    }
+
+    cloud.width = cloud.points.size();
+    cloud.height = 1;
+}
+
 void ElasticFusion::processFrame(const unsigned char * rgb,
                                  const unsigned short * depth,
                                  //const unsigned char * labelrgb,
@@ -316,69 +348,23 @@ void ElasticFusion::processFrame(const unsigned char * rgb,
 
         resize.vertex_noDownSampling(&segmentation.vertexTexture, vertexBuff);
 
-        pcl::PointCloud<pcl::PointXYZRGB>::Ptr cloud ( new pcl::PointCloud<pcl::PointXYZRGB> );
-        int size = 640*480;
-        // 遍历深度图
-        for (int i = 0; i < 480; i++){
-            for (int j=0; j < 640; j++)
-            {
-
-                // d 存在值，则向点云增加一个点
-                pcl::PointXYZRGB p;
-
-                //Intrinsics & getInstance(float fx = 0,float fy = 0,float cx = 0,float cy = 0);
-                //Intrinsics::getInstance(558, 558, 315, 241);
-                // 计算这个点的空间坐标
-                p.x = vertexBuff.at<Eigen::Vector4f>(i, j)(0);
-                p.y = vertexBuff.at<Eigen::Vector4f>(i, j)(1);
-                p.z =vertexBuff.at<Eigen::Vector4f>(i, j)(2);
-
-                // 从rgb图像中获取它的颜色
-                // rgb是三通道的BGR格式图，所以按下面的顺序获取颜色
-                int index=(640*i+j)*3;
-                p.b = rgb[index+2];
-                p.g = rgb[index+1];
-                p.r = rgb[index];
-
-                // 把p加入到点云中
-                cloud->points.push_back( p );
-            }
-        }
-        // 设置并保存点云
-        cloud->height = 1;
-        cloud->width = cloud->points.size();
-
+        //Normals for the segmentation come from the GPU instead of being estimated on the CPU
+        segmentation.normal(textures[GPUTexture::DEPTH_METRIC_FILTERED],currPose,0);
+        resize.normal_noDownSampling(&segmentation.normalTexture, normBuff);
 
+        pcl::PointCloud<pcl::PointXYZRGB>::Ptr cloud;
+        pcl::PointCloud<pcl::Normal>::Ptr normals;
+        //Organized 640x480 clouds so the supervoxel extraction can use the pixel grid
+        frameCloud.fill(vertexBuff,rgb,normBuff,cloud,normals);
+        int size = 640*480;
 
-        pcl::PointCloud<pcl::PointXYZL>::Ptr cloudseg;
-        myLccp mylccp;
-        mylccp.mySeg(cloud,cloudseg);
 
 
         float labelColor[640*480];
+        mylccp.mySeg(cloud,normals,labelColor);//labelColor now holds the segment label of every pixel
 
-        /*for(int i=0;i<size;i++)
-        {
-            labelColor[i]=cloudseg->points[i].label;
-        }*/
-        std::map<int,float>lab_map;
-        for(int i=0;i<size;i++)
-        {
-            int temp=cloudseg->points[i].label;
-            if(temp==0)
-            {
-                labelColor[i]=0;
-            }
-            else
-            {
-                if(lab_map[temp]==0)
-                {
-                    label_count++;
-                    lab_map[temp]=label_count;
-                }
-                labelColor[i]=lab_map[temp];
-            }
-        }
+        //Segment labels become global ids starting after label_count
+        labelRemap.apply(labelColor,size,label_count);
         textures[GPUTexture::LABEL_RGB]->texture->Upload(labelColor,  GL_LUMINANCE, GL_FLOAT );
 
         computeFeedbackBuffers();//compute中初始化了*feedbackBuffers的数据(着色器内部计算法向量)
@@ -703,297 +689,77 @@ void ElasticFusion::processFrame(const unsigned char * rgb,
             TOCK("indexMap");
 
 
-            //nemo-add----------
-            //读取标准特征用于后续对比
-            ifstream in("up.txt",ios::in);
-            float standard_feature[8];
-            for(int i=0;i<8;i++)
-            {
-                in>>standard_feature[i];
-            }
-            in.close();
-            //done------------------
             int obj_label=-1;  //识别的对象的label
-            std::vector<pcl::PointCloud<pcl::PointXYZLNormal>>label_cloud; //存储点云块
             frameNum++;
             //if(!find_target&&frameNum>50)
             if(frameNum==55)
             {
                 //nemo-add---------------
                 //读取所有点云,基于label,分为不同的点云块
-                std::vector<int>global_label;                                        //存储GM的label
                 Eigen::Vector4f * mapdata = globalModel.downloadMap();
 
 
-                //std::cout<<"666"<<std::endl;
-                for(unsigned int i = 0; i < globalModel.lastCount(); i++)
-                {
-                    pcl::PointXYZLNormal p;
-                    Eigen::Vector4f pos = mapdata[(i * 3) + 0];//position
-                    Eigen::Vector4f col = mapdata[(i * 3) + 1];//0->color,1->label
-                    Eigen::Vector4f nor = mapdata[(i * 3) + 2];//normal
-
-                    p.x=pos[0];    //生成一个PointXYZLNormal类型的点
-                    p.y=pos[1];
-                    p.z=pos[2];
-                    p.label=col[1];
-                    p.normal_x=nor[0];
-                    p.normal_y=nor[1];
-                    p.normal_z=nor[2];
-
-                    bool find_label=false;
-                    for(int i=0;i<global_label.size();i++)
-                    {
-                        if(global_label[i]==col[1])
-                        {
-                            find_label=true;
-                            //if find,add point to label_cloud[i]
-                            label_cloud[i].points.push_back(p);
-                        }
-                    }
-                    if(!find_label)
-                    {
-                        pcl::PointCloud<pcl::PointXYZLNormal> temp_cloud;
-                        temp_cloud.points.push_back(p);
-                        //temp_cloud.push_back(p);
-                        //两个vector数量相同,都含有相同label
-                        global_label.push_back(col[1]);        //将label添加到global_label
-                        label_cloud.push_back(temp_cloud);     //将点云块放入label_cloud
-                    }
-                }
-
-
-                //std::cout<<"global_label数量:"<<global_label.size()<<endl;
-                //std::cout<<"label_cloud数量:"<<label_cloud.size()<<endl;
-
-                
-                //nemo-add---------------
-                //依次遍历所有点云,得到bounding box以及中心
-                int cut_times=6;    //n为切割次数
-                std::vector<std::vector<float>>cloud_feature;
-                std::vector<float>f_angle(8*cut_times-8);         //将角度作为特征
-
-                //获取bounding box相关数据
-                for(int i=0;i<label_cloud.size();i++)
-                {
-                    int pc_count=label_cloud[i].size();    //当前点云的size
-
+                //Bucket the surfels by label in one counting sort, every segment is a span of surfelSegments
+                surfelSegments.extract(mapdata, globalModel.lastCount());
+                delete [] mapdata;
 
-                    pcl::PointCloud<pcl::PointXYZLNormal>::Ptr ptr_cloud(new pcl::PointCloud<pcl::PointXYZLNormal>(label_cloud[i]));
-                    pcl::MomentOfInertiaEstimation <pcl::PointXYZLNormal> feature_extractor;
-                    feature_extractor.setInputCloud (ptr_cloud);
-                    feature_extractor.compute ();
+                //Oriented boxes of all segments at once from their principal axes
+                segmentBoxes.compute(surfelSegments);
 
-                    pcl::PointXYZLNormal min_point_OBB;
-                    pcl::PointXYZLNormal max_point_OBB;
-                    pcl::PointXYZLNormal position_OBB;
-                    Eigen::Matrix3f rotational_matrix_OBB;
+                //Segments stay spans of surfelSegments, a cloud is only built for the ones written to disk
+                pcl::PointCloud<pcl::PointXYZLNormal> segment_cloud;
 
-                    feature_extractor.getOBB (min_point_OBB, max_point_OBB, position_OBB, rotational_matrix_OBB);
 
-                    float x_c=position_OBB.x;
-                    float y_c=position_OBB.y;
-                    float z_c=position_OBB.z;
-
-                    float x_max=x_c+max_point_OBB.x;
-                    float y_max=y_c+max_point_OBB.y;
-                    float x_min=x_c-max_point_OBB.x;
-                    float y_min=y_c-max_point_OBB.y;
-                    //点云旋转
-                    Eigen::Matrix3f pc_rotate=rotational_matrix_OBB.inverse();  //矩阵求逆
-                    for(int j=0;j<pc_count;j++)
-                    {
-                        float x=label_cloud[i].points[j].x-position_OBB.x;    //旋转坐标=（初始坐标-中心坐标）×旋转矩阵+中心坐标
-                        float y=label_cloud[i].points[j].y-position_OBB.y;
-                        float z=label_cloud[i].points[j].z-position_OBB.z;
-                        float norm_x=label_cloud[i].points[j].normal_x;
-                        float norm_y=label_cloud[i].points[j].normal_y;
-                        float norm_z=label_cloud[i].points[j].normal_z;
-
-                        label_cloud[i].points[j].x=x*pc_rotate(0,0)+y*pc_rotate(0,1)+z*pc_rotate(0,2)+position_OBB.x;
-                        label_cloud[i].points[j].y=x*pc_rotate(1,0)+y*pc_rotate(1,1)+z*pc_rotate(1,2)+position_OBB.y;
-                        label_cloud[i].points[j].z=x*pc_rotate(2,0)+y*pc_rotate(2,1)+z*pc_rotate(2,2)+position_OBB.z;
-
-                        //向量旋转可以直接乘以矩阵得到结果
-
-                        label_cloud[i].points[j].normal_x=norm_x*pc_rotate(0,0)+norm_y*pc_rotate(0,1)+norm_z*pc_rotate(0,2);;
-                        label_cloud[i].points[j].normal_y=norm_x*pc_rotate(1,0)+norm_y*pc_rotate(1,1)+norm_z*pc_rotate(1,2);;
-                        label_cloud[i].points[j].normal_z=norm_x*pc_rotate(2,0)+norm_y*pc_rotate(2,1)+norm_z*pc_rotate(2,2);;
-
-                    }
-
-                    float bb_depth=max_point_OBB.z-min_point_OBB.z;
-                    float z_increment=bb_depth/cut_times;
-                    float threshold=z_increment*0.025;
-
-                    float z_cur=position_OBB.z-0.5*bb_depth;     //也可以写成position_OBB.z-max_point_OBB.z
-                    //旧的bounding box 初始化方法
-                    //初始化为第一个点的xyz
-                    //                    float x_max=label_cloud[i].points[0].x,x_min=label_cloud[i].points[0].x;
-                    //                    float y_max=label_cloud[i].points[0].y,y_min=label_cloud[i].points[0].y;
-                    //                    float z_max=label_cloud[i].points[0].z,z_min=label_cloud[i].points[0].z;
-                    //                    for(int j=1;j<pc_count;j++)
-                    //                    {
-                    //                        float x=label_cloud[i].points[j].x;
-                    //                        float y=label_cloud[i].points[j].y;
-                    //                        float z=label_cloud[i].points[j].z;
-                    //                        if(x_max<x)
-                    //                        {
-                    //                            x_max=x;
-                    //                        }
-                    //                        if(y_max<y)
-                    //                        {
-                    //                            y_max=y;
-                    //                        }
-                    //                        if(z_max<z)
-                    //                        {
-                    //                            z_max=z;
-                    //                        }
-
-                    //                        if(x_min>x)
-                    //                        {
-                    //                            x_min=x;
-                    //                        }
-                    //                        if(y_min>y)
-                    //                        {
-                    //                            y_min=y;
-                    //                        }
-                    //                        if(z_min>z)
-                    //                        {
-                    //                            z_min=z;
-                    //                        }
-                    //                    }
-                    
-
-                    //                    //center of bounding box
-                    //                    float x_c=(x_max+x_min)/2,y_c=(y_max+y_min)/2,z_c=(z_max+z_min)/2;
-
-
-                    //                    float z_increment=(z_max-z_min)/cut_times;
-                    //                    float z_cur=z_min;
+                //std::cout<<"segment数量:"<<surfelSegments.size()<<endl;
 
+                
+                //Slice angle descriptors of all segments, in the frame of their boxes
+                sliceDescriptors.compute(surfelSegments,segmentBoxes);
 
+                //Best objects of every segment at once
+                const int numCandidates=3;
+                descriptorMatcher.match(sliceDescriptors.data(),sliceDescriptors.size(),sliceDescriptors.dimensions(),numCandidates);
 
-                    //获取五组角度,存放在f_angle中
-                    for(int k=1;k<cut_times;k++)
-                    {
-                        z_cur+=z_increment;
-                        //遍历点云,找到z在z_cur附近的点云
-                        for(int num=0;num<pc_count;num++)
-                        {
-                            float z=label_cloud[i].points[num].z;
-                            if(z>z_cur-threshold && z<z_cur+threshold)    //满足条件条件的点即当前切割面上的点
-                            {
-                                float x=label_cloud[i].points[num].x;
-                                float y=label_cloud[i].points[num].y;
-                                //顺时针 寻找
-                                Eigen::Vector3f temp_nor(label_cloud[i].points[num].normal_x,label_cloud[i].points[num].normal_y,label_cloud[i].points[num].normal_z);
-                                Eigen::Vector3f location(x_c-x,y_c-y,z_c-z);    //中心位置到该点的向量
-                                float cos;
-                                cos=acos((temp_nor(0)*location(0)+temp_nor(1)*location(1)+temp_nor(2)*location(2))/sqrt(location(0)*location(0)+location(1)*location(1)+location(2)*location(2)))*180.0/3.141592653;
-                                float x1=std::fabs(x-x_c);
-                                if(x1<=0.001 && y>y_c)
-                                {
-                                    //第1个
-                                    f_angle[(k-1)*8]=cos;
-                                    continue;
-                                    //p_normal[(k-1)*8]=temp_nor;
-                                }
-                                float slope=(y-y_c)/(x-x_c);
-                                float slope1=(y_max-y_c)/(x_max-x_c);
-                                if(std::fabs(slope-slope1)<0.01)
-                                {
-                                    //第2个
-                                    f_angle[(k-1)*8+1]=cos;
-                                    continue;
-                                    //p_normal[(k-1)*8+1]=temp_nor;
-                                }
-
-                                float y1=std::fabs(y-y_c);
-                                if(y1<=0.001 && x>x_c)
-                                {
-                                    //第3个
-                                    f_angle[(k-1)*8+2]=cos;
-                                    continue;
-                                    //p_normal[(k-1)*8+2]=temp_nor;
-                                }
-                                float slope2=(y_min-y_c)/(x_max-x_c);
-                                if(std::fabs(slope-slope2)<0.01)
-                                {
-                                    //第4个
-                                    f_angle[(k-1)*8+3]=cos;
-                                    continue;
-                                    //p_normal[(k-1)*8+3]=temp_nor;
-                                }
-                                if(x1<=0.001 && y<y_c)
-                                {
-                                    //第5个
-                                    f_angle[(k-1)*8+4]=cos;
-                                    continue;
-                                    //p_normal[(k-1)*8+4]=temp_nor;
-                                }
-                                float slope3=(y_min-y_c)/(x_min-x_c);
-                                if(std::fabs(slope-slope3)<0.01)
-                                {
-                                    //第6个
-                                    f_angle[(k-1)*8+5]=cos;
-                                    continue;
-                                    //p_normal[(k-1)*8+5]=temp_nor;
-                                }
-                                if(y1<=0.001 && x<x_c)
-                                {
-                                    //第7个
-                                    f_angle[(k-1)*8+6]=cos;
-                                    continue;
-                                    //p_normal[(k-1)*8+6]=temp_nor;
-                                }
-                                float slope4=(y_max-y_c)/(x_min-x_c);
-                                if(std::fabs(slope-slope4)<0.01)
-                                {
-                                    //第8个
-                                    f_angle[(k-1)*8+7]=cos;
-                                    continue;
-                                    //p_normal[(k-1)*8+7]=temp_nor;
-                                }
-                            }
-                        }
-                    }
-                    cloud_feature.push_back(f_angle);
-
-                }
                 //std::cout<<"cloud_feature数量:"<<cloud_feature.size()<<endl;
                 std::string plyname;
                 std::string txtname;
                 std::string path="/home/nemo/Desktop/pc_data/";
                 char  temp_file[5];
                 int num=1;
-                std::vector<int>aa(label_cloud.size(),0);
-                for(int i=0;i<label_cloud.size();i++)
+                std::vector<int>aa(surfelSegments.size(),0);
+                for(int i=0;i<surfelSegments.size();i++)
                 {
-                    //std::cout<<"第"<<i<<"块大小:"<<label_cloud.size()<<endl;
+                    //std::cout<<"第"<<i<<"块大小:"<<surfelSegments.count(i)<<endl;
                     //输出所有点云数量大于1000的点云快
-                    if(label_cloud[i].size()>1000)
+                    if(surfelSegments.count(i)>1000)
                     {
+                        segmentCloud(i,segment_cloud);
                         sprintf(temp_file,"%04d",num);
                         plyname = temp_file;
                         plyname = path+plyname+".ply";
-                        pcl::io::savePLYFile(plyname,label_cloud[i]);
+                        pcl::io::savePLYFile(plyname,segment_cloud);
                         txtname = temp_file;
                         txtname = path+txtname+".txt";
                         ofstream out(txtname,ios::out);
-                        for(int j=1;j<=cloud_feature[i].size();j++)
+                        out<<"# version "<<SliceDescriptors::version<<endl;
+                        //Every cut as a comment, the middle cut (the same one whichever way the minor axis points) is
+                        //the 8 value template, so the file can be imported into the object library as it is
+                        const float * feature = sliceDescriptors.descriptor(i);
+                        const int cuts = sliceDescriptors.dimensions()/SliceDescriptors::numSectors;
+                        for(int c=0;c<cuts;c++)
                         {
-                            out<<cloud_feature[i][j-1];
-                            int aa=j%8;
-                            if(aa==0)
-                            {
-                                out<<endl;
-                            }
-                            else
+                            out<<"# cut "<<c+1<<":";
+                            for(int j=0;j<SliceDescriptors::numSectors;j++)
                             {
-                                out<<" ";
+                                out<<" "<<feature[c*SliceDescriptors::numSectors+j];
                             }
+                            out<<endl;
                         }
+                        for(int j=0;j<SliceDescriptors::numSectors;j++)
+                        {
+                            out<<feature[(cuts-1)/2*SliceDescriptors::numSectors+j]<<(j+1<SliceDescriptors::numSectors ? " " : "");
+                        }
+                        out<<endl;
                         out.close();
                         num++;
                     }
@@ -1016,29 +782,14 @@ void ElasticFusion::processFrame(const unsigned char * rgb,
 //                                                //pcl::io::savePCDFile("get.pcd",label_cloud[i]);
 //                                            }
 //                                        }
-                                        if(label_cloud[i].size()>500)
+                                        if(surfelSegments.count(i)>500)
                                         {
-                                            int count=0;
-                                            int temp_count=0;
-                                            for(int j=0;j<cloud_feature[i].size();j++)
-                                            {
-                                                if(cloud_feature[i][j]>standard_feature[j%8]-15 && cloud_feature[i][j]<standard_feature[j%8]+15)
-                                                {temp_count++;}
-                                                if((j+1)%8==0)
-                                                {
-                                                    if(temp_count>count)
-                                                    {count=temp_count;}
-                                                    temp_count=0;
-                                                }
-                                            }
+                                            const DescriptorMatcher::Match & match=descriptorMatcher.matches(i)[0];
 
-                                            if(count>=5)
+                                            if(match.object>=0)
                                             {
                                                 //识别成功,记录当前i;
-                                                aa[i]=count;
-
-                                                //find_target=true;
-                                                //pcl::io::savePCDFile("get.pcd",label_cloud[i]);
+                                                aa[i]=match.score;
                                             }
                                         }
                 }
@@ -1056,9 +807,15 @@ void ElasticFusion::processFrame(const unsigned char * rgb,
                                 }
                                 if(max_i>=0)
                                 {
-                                    obj_label=global_label[max_i];
+                                    obj_label=surfelSegments.label(max_i);
                                     cout<<"obj_label:"<<obj_label<<endl;
-                                    pcl::io::savePLYFile("get.ply",label_cloud[max_i]);
+                                    for(int c=0;c<numCandidates && descriptorMatcher.matches(max_i)[c].object>=0;c++)
+                                    {
+                                        const DescriptorMatcher::Match & match=descriptorMatcher.matches(max_i)[c];
+                                        cout<<objectLibrary.name(match.object)<<": "<<match.score<<endl;
+                                    }
+                                    segmentCloud(max_i,segment_cloud);
+                                    pcl::io::savePLYFile("get.ply",segment_cloud);
                                     std::cout<<"识别成功!"<<endl;
                                 }
                                 else
@@ -1077,218 +834,72 @@ void ElasticFusion::processFrame(const unsigned char * rgb,
             //       ifUpdatelabel=true;
             /*********  begin  ************************************************************************************************************/
 
-            segmentation.vertex(textures[GPUTexture::DEPTH_METRIC],currPose,1);//DEPTH_RAW DEPTH_METRIC DEPTH_METRIC_FILTERED
+            //Segmented in the camera frame, where pixels without depth stay at zero and normals are oriented towards the camera
+            segmentation.vertex(textures[GPUTexture::DEPTH_METRIC],currPose,0);//DEPTH_RAW DEPTH_METRIC DEPTH_METRIC_FILTERED
 
             resize.vertex_noDownSampling(&segmentation.vertexTexture, vertexBuff);
 
-            pcl::PointCloud<pcl::PointXYZRGB>::Ptr cloud ( new pcl::PointCloud<pcl::PointXYZRGB> );
-            int size = 640*480;
-            // 遍历深度图
-            for (int i = 0; i < 480; i++){
-                for (int j=0; j < 640; j++)
-                {
-
-                    // d 存在值，则向点云增加一个点
-                    pcl::PointXYZRGB p;
-
-                    //Intrinsics & getInstance(float fx = 0,float fy = 0,float cx = 0,float cy = 0);
-                    //Intrinsics::getInstance(558, 558, 315, 241);
-                    // 计算这个点的空间坐标
-                    p.x = vertexBuff.at<Eigen::Vector4f>(i, j)(0);
-                    p.y = vertexBuff.at<Eigen::Vector4f>(i, j)(1);
-                    p.z = vertexBuff.at<Eigen::Vector4f>(i, j)(2);
-
-                    // 从rgb图像中获取它的颜色
-                    // rgb是三通道的BGR格式图，所以按下面的顺序获取颜色
-                    int index=(640*i+j)*3;
-                    p.b = rgb[index+2];
-                    p.g = rgb[index+1];
-                    p.r = rgb[index];
-
-                    // 把p加入到点云中
-                    cloud->points.push_back( p );
-                }
-            }
-            // 设置并保存点云
-            cloud->height = 1;
-            cloud->width = cloud->points.size();
-
-
-
-            pcl::PointCloud<pcl::PointXYZL>::Ptr cloudseg;
-            myLccp mylccp;
-            mylccp.mySeg(cloud,cloudseg);
-
-
-            float labelColor[640*480];
-            /*for(int i=0;i<size;i++)
-                {
-                    labelColor[i]=cloudseg->points[i].label;
-                }*/
-            std::map<int,float>lab_map;
-            for(int i=0;i<size;i++)
-            {
-                int temp=cloudseg->points[i].label;
-                if(temp==0)
-                {
-                    labelColor[i]=0;
-                }
-                else
-                {
-                    if(lab_map[temp]==0)
-                    {
-                        label_count++;
-                        lab_map[temp]=label_count;
-                    }
-                    labelColor[i]=lab_map[temp];
-                }
-            }
-
             //-----nemo add--------------
             resize.normal_noDownSampling(indexMap.colorTimeTex(),colorTimeBuff);
 
+            int size = 640*480;
 
-
-            std::vector<int>li;      //投影得到的label
-            std::vector<int>li_count;
-            std::vector<int>lj;      //当前分割得到的label
-            std::vector<int>lj_count;
-
-
-
-            for (int i = 0; i < 480; i++)
-            {
-                for (int j=0; j < 640; j++)
-                {
-
-                    int label_pro=colorTimeBuff.at<Eigen::Vector4f>(i, j)(1);
-                    bool findi=false;
-                    //将新label与vector存储的label进行对比
-                    for(int i=0;i<li.size();i++)
-                    {
-                        if (label_pro==li[i])
-                        {
-                            li_count[i]++;  //相同则label对应的count加一
-                            findi=true;
-                            break;
-                        }
-
-                    }
-                    if(!findi)
-                    {
-                        li.push_back(label_pro);
-                        li_count.push_back(1);
-                    }
-
-
-                    int label_pro1=labelColor[i*640+j];
-                    bool findj=false;
-                    //将新label与vector存储的label进行对比
-                    for(int i=0;i<lj.size();i++)
-                    {
-                        if (label_pro1==lj[i])
-                        {
-                            lj_count[i]++;  //相同则label对应的count加一
-                            findj=true;
-                            break;
-                        }
-
-                    }
-                    if(!findj)
-                    {//std::cout<<"l:"<<label_pro1<<" ";
-                        lj.push_back(label_pro1);
-                        lj_count.push_back(1);
-                    }
-
-
-                }
-            }
-            //                           std::cout<<"label i:"<<li.size()<<" "<<li_count[0]<<std::endl;//li
-            //                           std::cout<<"label j:"<<lj.size()<<" "<<lj_count[0]<<std::endl;//lj
-
-            //创建二位数组label_ij用于存储(li,lj)
-            //vector<vector <int> > ivec(m ,vector<int>(n,0)); //m*n的二维vector，所有元素初始化为0
-            std::vector< std::vector<int>> label_ij(li.size(), std::vector<int>(lj.size(),0));
-
-            /*
-                            * 运行判据需要的四个数据：
-                            *
-                            * Img<Eigen::Vector4f> normBuff;
-                            * Img<Eigen::Vector4f> vertexBuff;     //当前深度图优化后得到的顶点图 vertexBuff.at<Eigen::Vector4f>(i, j)(0);
-                            * Img<Eigen::Vector4f> colorTimeBuff;  //从indexMap.colorTimeTex()
-                            * Img<Eigen::Vector4f> vertConfBuff;   //indexMap.vertConfTex()
-                            * Img<Eigen::Vector4f> normalRadBuff;  //indexMap.normalRadTex()
-                            */
-            segmentation.normal(textures[GPUTexture::DEPTH_METRIC_FILTERED],currPose,1);//DEPTH_RAW DEPTH_METRIC DEPTH_METRIC_FILTERED
-            resize.normal_noDownSampling(&segmentation.normalTexture,normBuff);
-            //resize.normal_noDownSampling(indexMap.vertConfTex(),vertConfBuff);
-            resize.normal_noDownSampling(indexMap.normalRadTex(),normalRadBuff);
-
-            //计算label_ij图
-            for (int i = 0; i < 480; i++)
+            //Full segmentation only when the scheduler asks for it, the model already carries labels for the rest
+            if(segmentationScheduler.shouldSegment(tick,currPose,SegmentationScheduler::unlabeledFraction(vertexBuff,colorTimeBuff),lastFrameNovel))
             {
-                for (int j=0; j < 640; j++)
-                {
-                    int label_pro = colorTimeBuff.at<Eigen::Vector4f>(i, j)(1);
-                    int label_cur = labelColor[i*640+j];
-
-                    //投影深度图
-                    float norm_pro[3] = {normalRadBuff.at<Eigen::Vector4f>(i,j)(0),normalRadBuff.at<Eigen::Vector4f>(i,j)(1),normalRadBuff.at<Eigen::Vector4f>(i,j)(2)};
-                    //当前深度图
-                    float norm_cur[3] = {normBuff.at<Eigen::Vector4f>(i,j)(0),normBuff.at<Eigen::Vector4f>(i,j)(1),normBuff.at<Eigen::Vector4f>(i,j)(2)};
+                //Normals for the segmentation come from the GPU instead of being estimated on the CPU
+                segmentation.normal(textures[GPUTexture::DEPTH_METRIC_FILTERED],currPose,0);
+                resize.normal_noDownSampling(&segmentation.normalTexture, normBuff);
 
-                    //计算对应点的向量的夹角（单位／度）
-                    int angle = acos( norm_pro[0]*norm_cur[0] + norm_pro[1]*norm_cur[1] + norm_pro[2]*norm_cur[2] )*180.0/3.141592653;
+                pcl::PointCloud<pcl::PointXYZRGB>::Ptr cloud;
+                pcl::PointCloud<pcl::Normal>::Ptr normals;
+                //Organized 640x480 clouds so the supervoxel extraction can use the pixel grid
+                frameCloud.fill(vertexBuff,rgb,normBuff,cloud,normals);
 
-
-                    //满足条件，则增加
-                    if( angle<20 && angle>-20)
-                    {
-                        int x =find(li.begin(),li.end(),label_pro) - li.begin();
-                        int y =find(lj.begin(),lj.end(),label_cur) - lj.begin();
-                        label_ij[x][y]++;
-                    }
-                }
+                //Segmentation runs on the worker thread, tracking continues with the newest finished result
+                segmentationWorker.submit(tick,currPose,cloud,normals);
             }
 
+            float labelColor[640*480];
 
-
-
-            //计算label_ij中每列，即lj对应的一列中最大的count值
-            std::vector<int> label_ij_maxCount(lj.size());
-            //count取最大时，对应的下标
-            std::vector<int> label_ij_iIndex(lj.size());
-            for(int i=0 ; i < lj.size() ; i++ )
+            if(segmentationWorker.getLatest(segmentationResult))
             {
-                label_ij_maxCount[i] = 0;
-                label_ij_iIndex[i] = 0 ;
-                for(int j=0 ; j < li.size() ; j++ )
-                {
-                    if(label_ij[j][i] > label_ij_maxCount[i])
-                    {
-                        label_ij_maxCount[i] = label_ij[j][i];
-                        label_ij_iIndex[i] = j ;
-                    }
-                }
+                //Give the segments of the new result fresh label numbers
+                labelRemap.apply(segmentationResult.labels.data(),size,label_count);
+
+                //Move the labels from the pose they were segmented at to the current one
+                segmentationWorker.reproject(segmentationResult,currPose,labelColor);
+
+                /*
+                                * 运行判据需要的四个数据：
+                                *
+                                * Img<Eigen::Vector4f> normBuff;
+                                * Img<Eigen::Vector4f> vertexBuff;     //当前深度图优化后得到的顶点图 vertexBuff.at<Eigen::Vector4f>(i, j)(0);
+                                * Img<Eigen::Vector4f> colorTimeBuff;  //从indexMap.colorTimeTex()
+                                * Img<Eigen::Vector4f> vertConfBuff;   //indexMap.vertConfTex()
+                                * Img<Eigen::Vector4f> normalRadBuff;  //indexMap.normalRadTex()
+                                */
+                //World frame normals to compare with the model, the camera frame ones above were only for the segmentation
+                segmentation.normal(textures[GPUTexture::DEPTH_METRIC_FILTERED],currPose,1);//DEPTH_RAW DEPTH_METRIC DEPTH_METRIC_FILTERED
+                resize.normal_noDownSampling(&segmentation.normalTexture,normBuff);
+                //resize.normal_noDownSampling(indexMap.vertConfTex(),vertConfBuff);
+                resize.normal_noDownSampling(indexMap.normalRadTex(),normalRadBuff);
+
+                //Only pixels whose normals are within 20 degrees of the model vote
+                NormalMask::agreement(&normalRadBuff.at<Eigen::Vector4f>(0),&normBuff.at<Eigen::Vector4f>(0),size,std::cos(20.0f*3.14159265f/180.0f),normalAgreement);
+
+                //Segments that mostly overlap one predicted label take that label over
+                labelAssociation.apply(&colorTimeBuff.at<Eigen::Vector4f>(0)(1),4,normalAgreement.data(),labelColor,size);
             }
-
-
-            //更新labelColor图
-            for(int i=0 ; i < label_ij_maxCount.size() ; i++ )
+            else
             {
-                if((float)label_ij_maxCount[i]/(float)lj_count[i]>0.3)
+                //Propagate the labels the model predicts for this view
+                for(int i=0;i<size;i++)
                 {
-                    int li_index = label_ij_iIndex[i];
-                    //如果满足条件，则修改labelColor图中的部分点的label值，否则不更新
-                    for(int j=0 ; j < size ; j++ )
-                    {
-                        if((int)labelColor[j] == lj[i])
-                        {
-                            labelColor[j] = li[ li_index ];
-                        }
-                    }
+                    labelColor[i]=vertexBuff.at<Eigen::Vector4f>(i)(2)>0 ? colorTimeBuff.at<Eigen::Vector4f>(i)(1) : 0.0f;
                 }
             }
+
             //将obj_label对应的对象颜色改变
             //code
             /*if(find_target && frameNum==50)
@@ -1416,7 +1027,7 @@ void ElasticFusion::processFrame(const unsigned char * rgb,
 void ElasticFusion::processFerns()
 {
     TICK("Ferns::addFrame");
-    ferns.addFrame(&fillIn.imageTexture, &fillIn.vertexTexture, &fillIn.normalTexture, currPose, tick, fernThresh);
+    lastFrameNovel = ferns.addFrame(&fillIn.imageTexture, &fillIn.vertexTexture, &fillIn.normalTexture, currPose, tick, fernThresh);
     TOCK("Ferns::addFrame");
 }
 
@@ -1765,6 +1376,35 @@ const int & ElasticFusion::getFernDeforms()
     return fernDeforms;
 }
 
+const SegmentationScheduler & ElasticFusion::getSegmentationScheduler()
+{
+    return segmentationScheduler;
+}
+
+const ObjectLibrary & ElasticFusion::getObjectLibrary()
+{
+    return objectLibrary;
+}
+
+bool ElasticFusion::reloadObjects()
+{
+    const bool ok = objectLibrary.reload();
+
+    return setObjectTemplates() && ok;
+}
+
+bool ElasticFusion::setObjectTemplates()
+{
+    if(!descriptorMatcher.setTemplates(objectLibrary))
+    {
+        std::cout << "Object descriptors have " << objectLibrary.dimensions() << " values but the matcher takes "
+                  << DescriptorMatcher::width << ", recognition is off" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
 std::map<std::string, FeedbackBuffer*> & ElasticFusion::getFeedbackBuffers()
 {
     return feedbackBuffers;
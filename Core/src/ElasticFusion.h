@@ -52,6 +52,17 @@
 #include <Eigen/LU>
 
 #include "myLccp.h"
+#include "SegmentationWorker.h"
+#include "SegmentationScheduler.h"
+#include "FrameCloud.h"
+#include "LabelRemap.h"
+#include "LabelAssociation.h"
+#include "Utils/NormalMask.h"
+#include "ObjectLibrary.h"
+#include "SurfelSegments.h"
+#include "SegmentBoxes.h"
+#include "SliceDescriptors.h"
+#include "DescriptorMatcher.h"
 
 
 class ElasticFusion
@@ -250,6 +261,24 @@ class ElasticFusion
          */
         EFUSION_API const int & getFernDeforms();
 
+        /**
+         * Counts of frames that were segmented and of frames whose labels came from the model
+         * @return
+         */
+        EFUSION_API const SegmentationScheduler & getSegmentationScheduler();
+
+        /**
+         * The object descriptors used by the recognition
+         * @return
+         */
+        EFUSION_API const ObjectLibrary & getObjectLibrary();
+
+        /**
+         * Reads the object descriptors from disk again and hands them to the matcher
+         * @return false if a catalogue or an imported file could not be read, or the descriptors do not fit the matcher
+         */
+        EFUSION_API bool reloadObjects();
+
         /**
          * These are the vertex buffers computed from the raw input data
          * @return can be rendered
@@ -301,6 +330,12 @@ class ElasticFusion
 
         bool denseEnough(const Img<Eigen::Matrix<unsigned char, 3, 1>> & img);
 
+        //Packs the library into the matcher and says so when its descriptors do not fit
+        bool setObjectTemplates();
+
+        //Points of one segment of surfelSegments as a cloud, for writing it out
+        void segmentCloud(const size_t segment, pcl::PointCloud<pcl::PointXYZLNormal> & cloud) const;
+
         void processFerns();
 
         Eigen::Vector3f rodrigues2(const Eigen::Matrix3f& matrix);
@@ -344,6 +379,7 @@ class ElasticFusion
         const bool reloc;
         bool lost;
         bool lastFrameRecovery;
+        bool lastFrameNovel;
         int trackingCount;
         const float maxDepthProcessed;
 
@@ -362,6 +398,19 @@ class ElasticFusion
         bool find_target;
         bool target_change;
         int label_count;    //总label数量
+        myLccp mylccp;      //persistent so segmentation storage is reused between frames
+        FrameCloud frameCloud;                          //recycled clouds the segmentation reads the frame from
+        LabelRemap labelRemap;                          //segment labels to global ids
+        LabelAssociation labelAssociation;              //new segments to the labels the model predicts
+        std::vector<uint32_t> normalAgreement;          //pixels whose normals agree with the model
+        ObjectLibrary objectLibrary;                    //descriptors of the objects to recognise
+        SurfelSegments surfelSegments;                  //model surfels grouped by label
+        SegmentBoxes segmentBoxes;                      //oriented box of every segment
+        SliceDescriptors sliceDescriptors;              //slice angle descriptor of every segment
+        DescriptorMatcher descriptorMatcher;            //library objects matching every segment
+        SegmentationWorker segmentationWorker;          //segments later frames off the tracking thread
+        SegmentationWorker::Result segmentationResult;  //newest segmentation, labels already renumbered
+        SegmentationScheduler segmentationScheduler;    //which frames get a full segmentation
 };
 
 #endif /* ELASTICFUSION_H_ */
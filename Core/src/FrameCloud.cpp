@@ -0,0 +1,93 @@
+/*
+ * This file is part of ElasticFusion.
+ *
+ * Copyright (C) 2015 Imperial College London
+ * 
+ * The use of the code within this file and all code within files that 
+ * make up the software that is ElasticFusion is permitted for 
+ * non-commercial purposes only.  The full terms and conditions that 
+ * apply to the code within this file are detailed within the LICENSE.txt 
+ * file and at <http://www.imperial.ac.uk/dyson-robotics-lab/downloads/elastic-fusion/elastic-fusion-license/> 
+ * unless explicitly stated.  By downloading this file you agree to 
+ * comply with these terms.
+ *
+ * If you wish to use any of this code for commercial purposes then 
+ * please email researchcontracts.engineering@imperial.ac.uk.
+ *
+ */
+
+#include "FrameCloud.h"
+
+#include "Utils/Parallel.h"
+
+FrameCloud::FrameCloud(const int width, const int height, const unsigned int numThreads)
+ : width(width),
+   height(height),
+   numThreads(numThreads)
+{
+
+}
+
+template<typename PointT>
+typename pcl::PointCloud<PointT>::Ptr FrameCloud::acquire(std::vector<typename pcl::PointCloud<PointT>::Ptr> & pool)
+{
+    for(size_t i = 0; i < pool.size(); i++)
+    {
+        //Only the pool holds it, nobody reads it any more
+        if(pool.at(i).use_count() == 1)
+        {
+            return pool.at(i);
+        }
+    }
+
+    typename pcl::PointCloud<PointT>::Ptr cloud(new pcl::PointCloud<PointT>);
+    cloud->points.resize(width * height);
+    cloud->width = width;
+    cloud->height = height;
+    cloud->is_dense = false;
+
+    pool.push_back(cloud);
+
+    return cloud;
+}
+
+void FrameCloud::fill(const Img<Eigen::Vector4f> & vertices,
+                      const unsigned char * rgb,
+                      const Img<Eigen::Vector4f> & normalMap,
+                      pcl::PointCloud<pcl::PointXYZRGB>::Ptr & cloud,
+                      pcl::PointCloud<pcl::Normal>::Ptr & normals)
+{
+    cloud = acquire<pcl::PointXYZRGB>(clouds);
+    normals = acquire<pcl::Normal>(normalClouds);
+
+    pcl::PointXYZRGB * points = &cloud->points[0];
+    pcl::Normal * normalPoints = &normals->points[0];
+
+    //PCL points are padded to 32 bytes, so they cannot alias the 16 byte Vector4f maps and are copied
+    Parallel::forRange(0, height, numThreads, [&](const size_t begin, const size_t end, const unsigned int)
+    {
+        for(size_t i = begin; i < end; i++)
+        {
+            for(int j = 0; j < width; j++)
+            {
+                const int index = i * width + j;
+                const Eigen::Vector4f & vertex = vertices.at<Eigen::Vector4f>(i, j);
+                const Eigen::Vector4f & normal = normalMap.at<Eigen::Vector4f>(i, j);
+
+                pcl::PointXYZRGB & p = points[index];
+                p.x = vertex(0);
+                p.y = vertex(1);
+                p.z = vertex(2);
+                p.r = rgb[index * 3];
+                p.g = rgb[index * 3 + 1];
+                p.b = rgb[index * 3 + 2];
+
+                pcl::Normal & n = normalPoints[index];
+                n.normal_x = normal(0);
+                n.normal_y = normal(1);
+                n.normal_z = normal(2);
+                n.curvature = 0;
+            }
+        }
+    }, 16);
+}
@@ -0,0 +1,61 @@
+/*
+ * This file is part of ElasticFusion.
+ *
+ * Copyright (C) 2015 Imperial College London
+ * 
+ * The use of the code within this file and all code within files that 
+ * make up the software that is ElasticFusion is permitted for 
+ * non-commercial purposes only.  The full terms and conditions that 
+ * apply to the code within this file are detailed within the LICENSE.txt 
+ * file and at <http://www.imperial.ac.uk/dyson-robotics-lab/downloads/elastic-fusion/elastic-fusion-license/> 
+ * unless explicitly stated.  By downloading this file you agree to 
+ * comply with these terms.
+ *
+ * If you wish to use any of this code for commercial purposes then 
+ * please email researchcontracts.engineering@imperial.ac.uk.
+ *
+ */
+
+#ifndef FRAMECLOUD_H_
+#define FRAMECLOUD_H_
+
+#include <vector>
+#include <Eigen/Core>
+#include <pcl/point_cloud.h>
+#include <pcl/point_types.h>
+
+#include "Utils/Img.h"
+
+/**
+ * Turns the vertex and normal maps read back from the GPU into organized PCL clouds for the segmentation.
+ * Clouds are recycled once nothing else holds them any more, e.g. after the segmentation worker
+ * has moved on, so a steady frame rate settles on a few preallocated clouds.
+ */
+class FrameCloud
+{
+    public:
+        FrameCloud(const int width, const int height, const unsigned int numThreads = 0);
+
+        /**
+         * Fills cloud and normals from the vertex map, the RGB image and the normal map, in parallel over rows
+         * @param rgb width * height * 3 bytes in RGB order
+         */
+        void fill(const Img<Eigen::Vector4f> & vertices,
+                  const unsigned char * rgb,
+                  const Img<Eigen::Vector4f> & normalMap,
+                  pcl::PointCloud<pcl::PointXYZRGB>::Ptr & cloud,
+                  pcl::PointCloud<pcl::Normal>::Ptr & normals);
+
+    private:
+        template<typename PointT>
+        typename pcl::PointCloud<PointT>::Ptr acquire(std::vector<typename pcl::PointCloud<PointT>::Ptr> & pool);
+
+        const int width;
+        const int height;
+        const unsigned int numThreads;
+
+        std::vector<pcl::PointCloud<pcl::PointXYZRGB>::Ptr> clouds;
+        std::vector<pcl::PointCloud<pcl::Normal>::Ptr> normalClouds;
+};
+
+#endif /* FRAMECLOUD_H_ */
@@ -0,0 +1,257 @@
+/*
+ * This file is part of ElasticFusion.
+ *
+ * Copyright (C) 2015 Imperial College London
+ * 
+ * The use of the code within this file and all code within files that 
+ * make up the software that is ElasticFusion is permitted for 
+ * non-commercial purposes only.  The full terms and conditions that 
+ * apply to the code within this file are detailed within the LICENSE.txt 
+ * file and at <http://www.imperial.ac.uk/dyson-robotics-lab/downloads/elastic-fusion/elastic-fusion-license/> 
+ * unless explicitly stated.  By downloading this file you agree to 
+ * comply with these terms.
+ *
+ * If you wish to use any of this code for commercial purposes then 
+ * please email researchcontracts.engineering@imperial.ac.uk.
+ *
+ */
+
+#include "LabelAssociation.h"
+
+#include <algorithm>
+
+#include "Utils/LabelIndex.h"
+#include "Utils/NormalMask.h"
+#include "Utils/Parallel.h"
+
+//Cells of all per thread dense histograms together, beyond that the histograms are hashed
+static const size_t maxDenseCells = 1 << 20;
+static const size_t grain = 4096;
+
+LabelAssociation::LabelAssociation(const unsigned int numThreads,
+                                   const float minOverlap)
+ : numThreads(Parallel::threadCount(numThreads)),
+   minOverlap(minOverlap)
+{
+
+}
+
+void LabelAssociation::compactLabels(const float * values, const size_t stride, const size_t size, const int maxValue,
+                                     std::vector<int> & index, std::vector<int> & value, std::vector<uint32_t> & first)
+{
+    const uint32_t unseen = 0xFFFFFFFF;
+
+    firstSeen.assign(numThreads * (maxValue + 1), unseen);
+
+    Parallel::forRange(0, size, numThreads, [&](const size_t begin, const size_t end, const unsigned int chunk)
+    {
+        uint32_t * seen = &firstSeen[chunk * (maxValue + 1)];
+
+        for(size_t i = begin; i < end; i++)
+        {
+            uint32_t & pixel = seen[LabelIndex::of(values[i * stride])];
+
+            if(pixel == unseen)
+            {
+                pixel = i;
+            }
+        }
+    }, grain);
+
+    index.assign(maxValue + 1, -1);
+    value.clear();
+    first.clear();
+
+    for(int label = 0; label <= maxValue; label++)
+    {
+        //Chunks are in pixel order, so the first one holding the label saw it first
+        for(unsigned int chunk = 0; chunk < numThreads; chunk++)
+        {
+            if(firstSeen[chunk * (maxValue + 1) + label] != unseen)
+            {
+                index[label] = value.size();
+                value.push_back(label);
+                first.push_back(firstSeen[chunk * (maxValue + 1) + label]);
+                break;
+            }
+        }
+    }
+}
+
+int LabelAssociation::apply(const float * predictedLabels,
+                            const size_t predictedStride,
+                            const uint32_t * agreement,
+                            float * labels,
+                            const size_t size)
+{
+    if(size == 0)
+    {
+        return 0;
+    }
+
+    chunkMax.assign(2 * numThreads, 0);
+
+    Parallel::forRange(0, size, numThreads, [&](const size_t begin, const size_t end, const unsigned int chunk)
+    {
+        int maxPredicted = 0;
+        int maxCurrent = 0;
+
+        for(size_t i = begin; i < end; i++)
+        {
+            maxPredicted = std::max(maxPredicted, LabelIndex::of(predictedLabels[i * predictedStride]));
+            maxCurrent = std::max(maxCurrent, LabelIndex::of(labels[i]));
+        }
+
+        chunkMax[2 * chunk] = maxPredicted;
+        chunkMax[2 * chunk + 1] = maxCurrent;
+    }, grain);
+
+    int maxPredicted = 0;
+    int maxCurrent = 0;
+
+    for(unsigned int chunk = 0; chunk < numThreads; chunk++)
+    {
+        maxPredicted = std::max(maxPredicted, chunkMax[2 * chunk]);
+        maxCurrent = std::max(maxCurrent, chunkMax[2 * chunk + 1]);
+    }
+
+    compactLabels(predictedLabels, predictedStride, size, maxPredicted, rowIndex, rowValue, rowFirst);
+    compactLabels(labels, 1, size, maxCurrent, colIndex, colValue, colFirst);
+
+    const size_t rows = rowValue.size();
+    const size_t cols = colValue.size();
+    const bool useDense = numThreads * rows * cols <= maxDenseCells;
+
+    if(useDense)
+    {
+        dense.assign(numThreads * rows * cols, 0);
+    }
+    else
+    {
+        sparse.resize(numThreads);
+
+        for(unsigned int chunk = 0; chunk < numThreads; chunk++)
+        {
+            sparse[chunk].clear();
+        }
+    }
+
+    colCount.assign(numThreads * cols, 0);
+
+    Parallel::forRange(0, size, numThreads, [&](const size_t begin, const size_t end, const unsigned int chunk)
+    {
+        int * histogram = useDense ? &dense[chunk * rows * cols] : 0;
+        int * count = &colCount[chunk * cols];
+
+        for(size_t i = begin; i < end; i++)
+        {
+            const int col = colIndex[LabelIndex::of(labels[i])];
+
+            count[col]++;
+
+            if(NormalMask::test(agreement, i))
+            {
+                const int row = rowIndex[LabelIndex::of(predictedLabels[i * predictedStride])];
+
+                if(useDense)
+                {
+                    histogram[row * cols + col]++;
+                }
+                else
+                {
+                    sparse[chunk][(long long)row * cols + col]++;
+                }
+            }
+        }
+    }, grain);
+
+    //Merge the threads and find the predicted label with the most votes for every segment,
+    //ties go to the label seen first in raster order
+    bestCount.assign(cols, 0);
+    bestRow.assign(cols, 0);
+
+    if(useDense)
+    {
+        for(unsigned int chunk = 1; chunk < numThreads; chunk++)
+        {
+            const int * histogram = &dense[chunk * rows * cols];
+
+            for(size_t cell = 0; cell < rows * cols; cell++)
+            {
+                dense[cell] += histogram[cell];
+            }
+        }
+
+        for(size_t row = 0; row < rows; row++)
+        {
+            for(size_t col = 0; col < cols; col++)
+            {
+                const int votes = dense[row * cols + col];
+
+                if(votes > bestCount[col] || (votes > 0 && votes == bestCount[col] && rowFirst[row] < rowFirst[bestRow[col]]))
+                {
+                    bestCount[col] = votes;
+                    bestRow[col] = row;
+                }
+            }
+        }
+    }
+    else
+    {
+        for(unsigned int chunk = 1; chunk < numThreads; chunk++)
+        {
+            for(std::unordered_map<long long, int>::const_iterator it = sparse[chunk].begin(); it != sparse[chunk].end(); ++it)
+            {
+                sparse[0][it->first] += it->second;
+            }
+        }
+
+        for(std::unordered_map<long long, int>::const_iterator it = sparse[0].begin(); it != sparse[0].end(); ++it)
+        {
+            const int row = it->first / cols;
+            const int col = it->first % cols;
+
+            if(it->second > bestCount[col] || (it->second == bestCount[col] && rowFirst[row] < rowFirst[bestRow[col]]))
+            {
+                bestCount[col] = it->second;
+                bestRow[col] = row;
+            }
+        }
+    }
+
+    for(unsigned int chunk = 1; chunk < numThreads; chunk++)
+    {
+        for(size_t col = 0; col < cols; col++)
+        {
+            colCount[col] += colCount[chunk * cols + col];
+        }
+    }
+
+    //Every pixel is relabeled once from its original segment
+    lookup.resize(cols);
+
+    int associated = 0;
+
+    for(size_t col = 0; col < cols; col++)
+    {
+        if((float)bestCount[col] / (float)colCount[col] > minOverlap)
+        {
+            lookup[col] = rowValue[bestRow[col]];
+            associated++;
+        }
+        else
+        {
+            lookup[col] = colValue[col];
+        }
+    }
+
+    Parallel::forRange(0, size, numThreads, [&](const size_t begin, const size_t end, const unsigned int)
+    {
+        for(size_t i = begin; i < end; i++)
+        {
+            labels[i] = lookup[colIndex[LabelIndex::of(labels[i])]];
+        }
+    }, grain);
+
+    return associated;
+}
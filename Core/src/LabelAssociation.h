@@ -0,0 +1,83 @@
+/*
+ * This file is part of ElasticFusion.
+ *
+ * Copyright (C) 2015 Imperial College London
+ * 
+ * The use of the code within this file and all code within files that 
+ * make up the software that is ElasticFusion is permitted for 
+ * non-commercial purposes only.  The full terms and conditions that 
+ * apply to the code within this file are detailed within the LICENSE.txt 
+ * file and at <http://www.imperial.ac.uk/dyson-robotics-lab/downloads/elastic-fusion/elastic-fusion-license/> 
+ * unless explicitly stated.  By downloading this file you agree to 
+ * comply with these terms.
+ *
+ * If you wish to use any of this code for commercial purposes then 
+ * please email researchcontracts.engineering@imperial.ac.uk.
+ *
+ */
+
+#ifndef LABELASSOCIATION_H_
+#define LABELASSOCIATION_H_
+
+#include <cstddef>
+#include <stdint.h>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * Matches the segments of a new label image to the labels the model predicts for the same view.
+ * One pass builds the histogram of (predicted, current) label pairs over the pixels whose normals agree (see NormalMask),
+ * every current segment that overlaps its best predicted label enough takes that label over.
+ * Labels that are not valid indices (see LabelIndex) count as 0.
+ */
+class LabelAssociation
+{
+    public:
+        /**
+         * @param minOverlap fraction of a segment's pixels that must vote for the same predicted label
+         */
+        LabelAssociation(const unsigned int numThreads = 0,
+                         const float minOverlap = 0.3f);
+
+        /**
+         * @param predictedLabels label the model predicts for every pixel, read with a stride of predictedStride floats
+         * @param agreement bit mask of the pixels that vote, e.g. where the predicted and current normals agree
+         * @param labels current segment labels, relabeled in place
+         * @return the number of segments that took over a predicted label
+         */
+        int apply(const float * predictedLabels,
+                  const size_t predictedStride,
+                  const uint32_t * agreement,
+                  float * labels,
+                  const size_t size);
+
+    private:
+        void compactLabels(const float * values, const size_t stride, const size_t size, const int maxValue,
+                           std::vector<int> & index, std::vector<int> & value, std::vector<uint32_t> & first);
+
+        const unsigned int numThreads;
+        const float minOverlap;
+
+        //Label value to row (predicted) and column (current) of the histogram, -1 if absent
+        std::vector<int> rowIndex;
+        std::vector<int> colIndex;
+        std::vector<int> rowValue;
+        std::vector<int> colValue;
+
+        //Pixel each label first appears at, the old association preferred labels seen earlier
+        std::vector<uint32_t> rowFirst;
+        std::vector<uint32_t> colFirst;
+        std::vector<uint32_t> firstSeen;
+        std::vector<int> chunkMax;
+
+        //Per thread histograms, dense while all of them together stay small, hashed otherwise
+        std::vector<int> dense;
+        std::vector<std::unordered_map<long long, int> > sparse;
+        std::vector<int> colCount;
+
+        std::vector<int> bestCount;
+        std::vector<int> bestRow;
+        std::vector<float> lookup;
+};
+
+#endif /* LABELASSOCIATION_H_ */
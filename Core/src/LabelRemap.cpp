@@ -0,0 +1,102 @@
+/*
+ * This file is part of ElasticFusion.
+ *
+ * Copyright (C) 2015 Imperial College London
+ * 
+ * The use of the code within this file and all code within files that 
+ * make up the software that is ElasticFusion is permitted for 
+ * non-commercial purposes only.  The full terms and conditions that 
+ * apply to the code within this file are detailed within the LICENSE.txt 
+ * file and at <http://www.imperial.ac.uk/dyson-robotics-lab/downloads/elastic-fusion/elastic-fusion-license/> 
+ * unless explicitly stated.  By downloading this file you agree to 
+ * comply with these terms.
+ *
+ * If you wish to use any of this code for commercial purposes then 
+ * please email researchcontracts.engineering@imperial.ac.uk.
+ *
+ */
+
+#include "LabelRemap.h"
+
+#include <algorithm>
+
+#include "Utils/LabelIndex.h"
+#include "Utils/Parallel.h"
+
+LabelRemap::LabelRemap(const unsigned int numThreads)
+ : numThreads(Parallel::threadCount(numThreads))
+{
+
+}
+
+void LabelRemap::apply(float * labels, const size_t size, int & lastId)
+{
+    const size_t grain = 4096;
+
+    chunkMax.assign(numThreads, 0);
+
+    Parallel::forRange(0, size, numThreads, [&](const size_t begin, const size_t end, const unsigned int chunk)
+    {
+        int maxLabel = 0;
+
+        for(size_t i = begin; i < end; i++)
+        {
+            maxLabel = std::max(maxLabel, LabelIndex::of(labels[i]));
+        }
+
+        chunkMax[chunk] = maxLabel;
+    }, grain);
+
+    const int numLabels = *std::max_element(chunkMax.begin(), chunkMax.end()) + 1;
+
+    chunkFirst.assign(numThreads * numLabels, -1);
+
+    Parallel::forRange(0, size, numThreads, [&](const size_t begin, const size_t end, const unsigned int chunk)
+    {
+        int * first = &chunkFirst[chunk * numLabels];
+
+        for(size_t i = begin; i < end; i++)
+        {
+            const int label = LabelIndex::of(labels[i]);
+
+            if(first[label] < 0)
+            {
+                first[label] = (int)i;
+            }
+        }
+    }, grain);
+
+    //Chunks cover the image in order, so the first chunk a label shows up in has its first pixel
+    order.clear();
+
+    for(int label = 1; label < numLabels; label++)
+    {
+        for(unsigned int chunk = 0; chunk < numThreads; chunk++)
+        {
+            if(chunkFirst[chunk * numLabels + label] >= 0)
+            {
+                order.push_back(std::make_pair(chunkFirst[chunk * numLabels + label], label));
+                break;
+            }
+        }
+    }
+
+    std::sort(order.begin(), order.end());
+
+    table.assign(numLabels, 0.0f);
+
+    for(size_t i = 0; i < order.size(); i++)
+    {
+        table[order[i].second] = (float)++lastId;
+    }
+
+    const float * lookup = table.data();
+
+    Parallel::forRange(0, size, numThreads, [&](const size_t begin, const size_t end, const unsigned int)
+    {
+        for(size_t i = begin; i < end; i++)
+        {
+            labels[i] = lookup[LabelIndex::of(labels[i])];
+        }
+    }, grain);
+}
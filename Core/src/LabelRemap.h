@@ -0,0 +1,52 @@
+/*
+ * This file is part of ElasticFusion.
+ *
+ * Copyright (C) 2015 Imperial College London
+ * 
+ * The use of the code within this file and all code within files that 
+ * make up the software that is ElasticFusion is permitted for 
+ * non-commercial purposes only.  The full terms and conditions that 
+ * apply to the code within this file are detailed within the LICENSE.txt 
+ * file and at <http://www.imperial.ac.uk/dyson-robotics-lab/downloads/elastic-fusion/elastic-fusion-license/> 
+ * unless explicitly stated.  By downloading this file you agree to 
+ * comply with these terms.
+ *
+ * If you wish to use any of this code for commercial purposes then 
+ * please email researchcontracts.engineering@imperial.ac.uk.
+ *
+ */
+
+#ifndef LABELREMAP_H_
+#define LABELREMAP_H_
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * Replaces the segment labels of a label image with global ids. Labels are numbered in the order
+ * they first appear in the image, whatever the number of threads, and 0 stays 0. Labels that are not
+ * valid indices (see LabelIndex) become 0.
+ * The lookup tables are dense, sized from the largest label, and kept between frames.
+ */
+class LabelRemap
+{
+    public:
+        LabelRemap(const unsigned int numThreads = 0);
+
+        /**
+         * @param labels segment labels, overwritten with global ids
+         * @param lastId the last global id handed out, advanced by the number of new labels
+         */
+        void apply(float * labels, const size_t size, int & lastId);
+
+    private:
+        const unsigned int numThreads;
+
+        //First pixel of every label in each chunk, -1 if absent
+        std::vector<int> chunkFirst;
+        std::vector<int> chunkMax;
+        std::vector<std::pair<int, int> > order;
+        std::vector<float> table;
+};
+
+#endif /* LABELREMAP_H_ */
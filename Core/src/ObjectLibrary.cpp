@@ -0,0 +1,323 @@
+/*
+ * This file is part of ElasticFusion.
+ *
+ * Copyright (C) 2015 Imperial College London
+ * 
+ * The use of the code within this file and all code within files that 
+ * make up the software that is ElasticFusion is permitted for 
+ * non-commercial purposes only.  The full terms and conditions that 
+ * apply to the code within this file are detailed within the LICENSE.txt 
+ * file and at <http://www.imperial.ac.uk/dyson-robotics-lab/downloads/elastic-fusion/elastic-fusion-license/> 
+ * unless explicitly stated.  By downloading this file you agree to 
+ * comply with these terms.
+ *
+ * If you wish to use any of this code for commercial purposes then 
+ * please email researchcontracts.engineering@imperial.ac.uk.
+ *
+ */
+
+#include "ObjectLibrary.h"
+
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+
+#ifndef WIN32
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
+
+static const char libraryMagic[4] = {'E', 'F', 'O', 'L'};
+static const uint32_t libraryVersion = 2;
+
+ObjectLibrary::ObjectLibrary(const uint32_t descriptorVersion)
+ : descriptorVersion(descriptorVersion),
+   mapped(0),
+   mappedBytes(0),
+   header(0),
+   names(0),
+   descriptors(0)
+{
+
+}
+
+ObjectLibrary::~ObjectLibrary()
+{
+    clear();
+}
+
+void ObjectLibrary::clear()
+{
+#ifndef WIN32
+    if(mapped)
+    {
+        munmap(mapped, mappedBytes);
+    }
+#endif
+
+    mapped = 0;
+    mappedBytes = 0;
+    owned.clear();
+    header = 0;
+    names = 0;
+    descriptors = 0;
+}
+
+bool ObjectLibrary::setImage(const char * data, const size_t bytes)
+{
+    if(bytes < sizeof(Header))
+    {
+        return false;
+    }
+
+    const Header * candidate = reinterpret_cast<const Header *>(data);
+
+    if(memcmp(candidate->magic, libraryMagic, 4) != 0 || candidate->version != libraryVersion || candidate->descriptorVersion != descriptorVersion ||
+       bytes != sizeof(Header) + (size_t)candidate->count * (nameLength + candidate->dimensions * sizeof(float)))
+    {
+        return false;
+    }
+
+    //Names are handed out as C strings, every one has to end inside its field
+    for(uint32_t i = 0; i < candidate->count; i++)
+    {
+        if(!memchr(data + sizeof(Header) + (size_t)i * nameLength, '\0', nameLength))
+        {
+            return false;
+        }
+    }
+
+    header = candidate;
+    names = data + sizeof(Header);
+    descriptors = reinterpret_cast<const float *>(names + (size_t)header->count * nameLength);
+
+    return true;
+}
+
+bool ObjectLibrary::load(const std::string & filename)
+{
+    clear();
+    catalogue = filename;
+    imports.clear();
+
+#ifndef WIN32
+    const int fd = open(filename.c_str(), O_RDONLY);
+
+    if(fd < 0)
+    {
+        return false;
+    }
+
+    struct stat info;
+
+    if(fstat(fd, &info) == 0 && info.st_size > 0)
+    {
+        void * data = mmap(0, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+        if(data != MAP_FAILED)
+        {
+            mapped = data;
+            mappedBytes = info.st_size;
+        }
+    }
+
+    close(fd);
+
+    if(!mapped || !setImage(static_cast<const char *>(mapped), mappedBytes))
+    {
+        clear();
+        return false;
+    }
+
+    return true;
+#else
+    std::ifstream file(filename.c_str(), std::ios::in | std::ios::binary);
+
+    if(!file.is_open())
+    {
+        return false;
+    }
+
+    owned.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+
+    if(!setImage(owned.data(), owned.size()))
+    {
+        clear();
+        return false;
+    }
+
+    return true;
+#endif
+}
+
+bool ObjectLibrary::importText(const std::string & filename, const std::string & name)
+{
+    if(!append(filename, name))
+    {
+        return false;
+    }
+
+    imports.push_back(std::make_pair(filename, name));
+
+    return true;
+}
+
+bool ObjectLibrary::append(const std::string & filename, const std::string & name)
+{
+    std::ifstream file(filename.c_str(), std::ios::in);
+
+    if(!file.is_open())
+    {
+        return false;
+    }
+
+    std::vector<float> values;
+    uint32_t fileVersion = 1;
+    std::string line;
+
+    while(std::getline(file, line))
+    {
+        std::istringstream stream(line);
+
+        if(line.compare(0, 1, "#") == 0)
+        {
+            std::string hash, key;
+
+            if(stream >> hash >> key && key == "version")
+            {
+                stream >> fileVersion;
+            }
+
+            continue;
+        }
+
+        float value;
+
+        while(stream >> value)
+        {
+            values.push_back(value);
+        }
+    }
+
+    if(fileVersion != descriptorVersion || values.empty() || (header && (size_t)header->dimensions != values.size()))
+    {
+        return false;
+    }
+
+    //Rebuild the image with the new entry appended, mapped catalogues become memory of our own from here on
+    const uint32_t count = size();
+    const uint32_t dims = values.size();
+
+    std::vector<char> image(sizeof(Header) + (size_t)(count + 1) * (nameLength + dims * sizeof(float)), 0);
+
+    Header * newHeader = reinterpret_cast<Header *>(image.data());
+    memcpy(newHeader->magic, libraryMagic, 4);
+    newHeader->version = libraryVersion;
+    newHeader->count = count + 1;
+    newHeader->dimensions = dims;
+    newHeader->descriptorVersion = descriptorVersion;
+
+    char * newNames = image.data() + sizeof(Header);
+    float * newDescriptors = reinterpret_cast<float *>(newNames + (size_t)(count + 1) * nameLength);
+
+    if(count > 0)
+    {
+        memcpy(newNames, names, (size_t)count * nameLength);
+        memcpy(newDescriptors, descriptors, (size_t)count * dims * sizeof(float));
+    }
+
+    strncpy(newNames + (size_t)count * nameLength, name.c_str(), nameLength - 1);
+    memcpy(newDescriptors + (size_t)count * dims, values.data(), dims * sizeof(float));
+
+    clear();
+    owned.swap(image);
+
+    return setImage(owned.data(), owned.size());
+}
+
+bool ObjectLibrary::save(const std::string & filename) const
+{
+    std::ofstream file(filename.c_str(), std::ios::out | std::ios::binary);
+
+    if(!file.is_open())
+    {
+        return false;
+    }
+
+    Header empty;
+    memcpy(empty.magic, libraryMagic, 4);
+    empty.version = libraryVersion;
+    empty.count = 0;
+    empty.dimensions = 0;
+    empty.descriptorVersion = descriptorVersion;
+
+    const char * data = header ? reinterpret_cast<const char *>(header) : reinterpret_cast<const char *>(&empty);
+    const size_t bytes = header ? sizeof(Header) + (size_t)header->count * (nameLength + header->dimensions * sizeof(float)) : sizeof(Header);
+
+    file.write(data, bytes);
+
+    return file.good();
+}
+
+bool ObjectLibrary::reload()
+{
+    const std::vector<std::pair<std::string, std::string> > texts = imports;
+
+    bool ok = true;
+
+    if(catalogue.empty())
+    {
+        clear();
+    }
+    else if(!load(catalogue))
+    {
+        //A catalogue that is not there (yet) just means the imports are all there is
+        ok = !std::ifstream(catalogue.c_str()).is_open();
+    }
+
+    //Imports that fail this time are kept and tried again on the next reload
+    imports = texts;
+
+    for(size_t i = 0; i < imports.size(); i++)
+    {
+        ok = append(imports.at(i).first, imports.at(i).second) && ok;
+    }
+
+    return ok;
+}
+
+size_t ObjectLibrary::size() const
+{
+    return header ? header->count : 0;
+}
+
+int ObjectLibrary::dimensions() const
+{
+    return header ? header->dimensions : 0;
+}
+
+const char * ObjectLibrary::name(const size_t i) const
+{
+    return names + i * nameLength;
+}
+
+const float * ObjectLibrary::descriptor(const size_t i) const
+{
+    return descriptors + i * header->dimensions;
+}
+
+int ObjectLibrary::find(const std::string & name) const
+{
+    for(size_t i = 0; i < size(); i++)
+    {
+        if(strncmp(this->name(i), name.c_str(), nameLength) == 0)
+        {
+            return i;
+        }
+    }
+
+    return -1;
+}
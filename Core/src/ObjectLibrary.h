@@ -0,0 +1,109 @@
+/*
+ * This file is part of ElasticFusion.
+ *
+ * Copyright (C) 2015 Imperial College London
+ * 
+ * The use of the code within this file and all code within files that 
+ * make up the software that is ElasticFusion is permitted for 
+ * non-commercial purposes only.  The full terms and conditions that 
+ * apply to the code within this file are detailed within the LICENSE.txt 
+ * file and at <http://www.imperial.ac.uk/dyson-robotics-lab/downloads/elastic-fusion/elastic-fusion-license/> 
+ * unless explicitly stated.  By downloading this file you agree to 
+ * comply with these terms.
+ *
+ * If you wish to use any of this code for commercial purposes then 
+ * please email researchcontracts.engineering@imperial.ac.uk.
+ *
+ */
+
+#ifndef OBJECTLIBRARY_H_
+#define OBJECTLIBRARY_H_
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+/**
+ * Named object descriptors for the recognition, loaded once instead of per frame.
+ * The binary catalogue is a 20 byte header, count names of 64 bytes and count * dimensions floats,
+ * so it is memory mapped as is and a large catalogue opens without parsing anything.
+ * Text files holding a single descriptor (like up.txt) can be imported on top.
+ *
+ * Descriptors carry the version of the extractor that produced them. Catalogues and text files of any
+ * other version are refused, so templates recorded before a change to the descriptor never get compared
+ * with new ones. Text files state it on a "# version N" line, files without one are version 1.
+ */
+class ObjectLibrary
+{
+    public:
+        ObjectLibrary(const uint32_t descriptorVersion = 1);
+
+        virtual ~ObjectLibrary();
+
+        /**
+         * Replaces the library with a binary catalogue
+         * @return false if the file is missing or malformed (including names without a terminating zero), the library is then empty
+         */
+        bool load(const std::string & filename);
+
+        /**
+         * Adds every float in a text file as one descriptor, lines starting with # are comments
+         * @return false if the file is missing, of another descriptor version or its length does not match the library
+         */
+        bool importText(const std::string & filename, const std::string & name);
+
+        bool save(const std::string & filename) const;
+
+        /**
+         * Loads the catalogue and the text imports again from disk, so edits are picked up without a restart
+         * @return false if a catalogue that exists or an import could not be read, a missing catalogue is no error
+         */
+        bool reload();
+
+        size_t size() const;
+
+        int dimensions() const;
+
+        const char * name(const size_t i) const;
+
+        const float * descriptor(const size_t i) const;
+
+        /**
+         * @return index of the descriptor called name, -1 if there is none
+         */
+        int find(const std::string & name) const;
+
+        static const int nameLength = 64;
+
+    private:
+        struct Header
+        {
+            char magic[4];
+            uint32_t version;
+            uint32_t count;
+            uint32_t dimensions;
+            uint32_t descriptorVersion;
+        };
+
+        void clear();
+
+        bool setImage(const char * data, const size_t bytes);
+
+        bool append(const std::string & filename, const std::string & name);
+
+        //Whatever backs the current image: a mapping of the catalogue or memory of our own
+        const uint32_t descriptorVersion;
+
+        void * mapped;
+        size_t mappedBytes;
+        std::vector<char> owned;
+
+        const Header * header;
+        const char * names;
+        const float * descriptors;
+
+        std::string catalogue;
+        std::vector<std::pair<std::string, std::string> > imports;
+};
+
+#endif /* OBJECTLIBRARY_H_ */
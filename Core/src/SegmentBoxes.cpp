@@ -0,0 +1,138 @@
+/*
+ * This file is part of ElasticFusion.
+ *
+ * Copyright (C) 2015 Imperial College London
+ * 
+ * The use of the code within this file and all code within files that 
+ * make up the software that is ElasticFusion is permitted for 
+ * non-commercial purposes only.  The full terms and conditions that 
+ * apply to the code within this file are detailed within the LICENSE.txt 
+ * file and at <http://www.imperial.ac.uk/dyson-robotics-lab/downloads/elastic-fusion/elastic-fusion-license/> 
+ * unless explicitly stated.  By downloading this file you agree to 
+ * comply with these terms.
+ *
+ * If you wish to use any of this code for commercial purposes then 
+ * please email researchcontracts.engineering@imperial.ac.uk.
+ *
+ */
+
+#include "SegmentBoxes.h"
+
+#include <algorithm>
+#include <limits>
+#include <Eigen/Eigenvalues>
+
+#include "Utils/Parallel.h"
+
+SegmentBoxes::SegmentBoxes(const unsigned int numThreads)
+ : numThreads(Parallel::threadCount(numThreads))
+{
+
+}
+
+Eigen::Matrix3f SegmentBoxes::axes(const Eigen::Matrix3f & covariance)
+{
+    //The general solver MomentOfInertiaEstimation uses, a symmetric solver returns other signs
+    Eigen::EigenSolver<Eigen::Matrix3f> solver(covariance);
+
+    const Eigen::Vector3f values = solver.eigenvalues().real();
+    const Eigen::Matrix3f vectors = solver.eigenvectors().real();
+
+    //Largest eigenvalue first, with the same swaps as PCL so equal eigenvalues resolve the same way
+    int major = 0;
+    int middle = 1;
+    int minor = 2;
+
+    if(values(major) < values(middle))
+    {
+        std::swap(major, middle);
+    }
+
+    if(values(major) < values(minor))
+    {
+        std::swap(major, minor);
+    }
+
+    if(values(middle) < values(minor))
+    {
+        std::swap(middle, minor);
+    }
+
+    Eigen::Matrix3f rotation;
+    rotation.col(0) = vectors.col(major).normalized();
+    rotation.col(1) = vectors.col(middle).normalized();
+    rotation.col(2) = vectors.col(minor).normalized();
+
+    //Right handed frame by flipping the major axis
+    if(rotation.col(0).dot(rotation.col(1).cross(rotation.col(2))) <= 0.0f)
+    {
+        rotation.col(0) = -rotation.col(0);
+    }
+
+    return rotation;
+}
+
+void SegmentBoxes::compute(const SurfelSegments & segments)
+{
+    boxes.resize(segments.size());
+
+    //Segments are independent, every one is summed in point order in float like MomentOfInertiaEstimation does, so the
+    //covariance matches it to the bit and the eigen solver, whose signs flip on the last bit, returns the same axes
+    Parallel::forRange(0, segments.size(), numThreads, [&](const size_t begin, const size_t end, const unsigned int)
+    {
+        for(size_t segment = begin; segment < end; segment++)
+        {
+            const uint32_t first = segments.begin(segment);
+            const uint32_t last = segments.end(segment);
+            const unsigned int numPoints = last - first;
+
+            Eigen::Vector3f mean = Eigen::Vector3f::Zero();
+
+            for(uint32_t i = first; i < last; i++)
+            {
+                mean(0) += segments.x[i];
+                mean(1) += segments.y[i];
+                mean(2) += segments.z[i];
+            }
+
+            mean /= (float)std::max(numPoints, 1u);
+
+            Eigen::Matrix3f covariance = Eigen::Matrix3f::Zero();
+
+            for(uint32_t i = first; i < last; i++)
+            {
+                const Eigen::Vector3f point(segments.x[i] - mean(0), segments.y[i] - mean(1), segments.z[i] - mean(2));
+                covariance += point * point.transpose();
+            }
+
+            covariance *= 1.0f / (float)(numPoints > 1 ? numPoints - 1 : 1);
+
+            Box & box = boxes[segment];
+            box.rotation = axes(covariance);
+
+            //Extents along the axes around the mean, then the box is centred on them like getOBB does
+            Eigen::Vector3f min = Eigen::Vector3f::Constant(std::numeric_limits<float>::max());
+            Eigen::Vector3f max = Eigen::Vector3f::Constant(-std::numeric_limits<float>::max());
+
+            for(uint32_t i = first; i < last; i++)
+            {
+                const float dx = segments.x[i] - mean(0);
+                const float dy = segments.y[i] - mean(1);
+                const float dz = segments.z[i] - mean(2);
+
+                for(int k = 0; k < 3; k++)
+                {
+                    const float projected = dx * box.rotation(0, k) + dy * box.rotation(1, k) + dz * box.rotation(2, k);
+                    min(k) = std::min(min(k), projected);
+                    max(k) = std::max(max(k), projected);
+                }
+            }
+
+            const Eigen::Vector3f shift = (min + max) / 2.0f;
+
+            box.position = mean + box.rotation * shift;
+            box.min = min - shift;
+            box.max = max - shift;
+        }
+    }, 1);
+}
@@ -0,0 +1,74 @@
+/*
+ * This file is part of ElasticFusion.
+ *
+ * Copyright (C) 2015 Imperial College London
+ * 
+ * The use of the code within this file and all code within files that 
+ * make up the software that is ElasticFusion is permitted for 
+ * non-commercial purposes only.  The full terms and conditions that 
+ * apply to the code within this file are detailed within the LICENSE.txt 
+ * file and at <http://www.imperial.ac.uk/dyson-robotics-lab/downloads/elastic-fusion/elastic-fusion-license/> 
+ * unless explicitly stated.  By downloading this file you agree to 
+ * comply with these terms.
+ *
+ * If you wish to use any of this code for commercial purposes then 
+ * please email researchcontracts.engineering@imperial.ac.uk.
+ *
+ */
+
+#ifndef SEGMENTBOXES_H_
+#define SEGMENTBOXES_H_
+
+#include <vector>
+#include <Eigen/Core>
+
+#include "SurfelSegments.h"
+
+/**
+ * Oriented bounding boxes of every segment from the principal axes of its points, the box
+ * pcl::MomentOfInertiaEstimation::getOBB gives but without the moment of inertia sweeps.
+ */
+class SegmentBoxes
+{
+    public:
+        class Box
+        {
+            public:
+                //Centre of the box
+                Eigen::Vector3f position;
+
+                //Columns are the major, middle and minor axis, a right handed frame with the signs getOBB gives
+                Eigen::Matrix3f rotation;
+
+                //Corners in the box frame relative to position, so min = -max
+                Eigen::Vector3f min;
+                Eigen::Vector3f max;
+        };
+
+        SegmentBoxes(const unsigned int numThreads = 0);
+
+        /**
+         * Segments are boxed in parallel, each with a mean, a covariance and an extents pass over its span
+         */
+        void compute(const SurfelSegments & segments);
+
+        size_t size() const
+        {
+            return boxes.size();
+        }
+
+        const Box & box(const size_t segment) const
+        {
+            return boxes[segment];
+        }
+
+    private:
+        //Axes from a covariance exactly as MomentOfInertiaEstimation picks and signs them
+        static Eigen::Matrix3f axes(const Eigen::Matrix3f & covariance);
+
+        const unsigned int numThreads;
+
+        std::vector<Box> boxes;
+};
+
+#endif /* SEGMENTBOXES_H_ */
@@ -0,0 +1,101 @@
+/*
+ * This file is part of ElasticFusion.
+ *
+ * Copyright (C) 2015 Imperial College London
+ * 
+ * The use of the code within this file and all code within files that 
+ * make up the software that is ElasticFusion is permitted for 
+ * non-commercial purposes only.  The full terms and conditions that 
+ * apply to the code within this file are detailed within the LICENSE.txt 
+ * file and at <http://www.imperial.ac.uk/dyson-robotics-lab/downloads/elastic-fusion/elastic-fusion-license/> 
+ * unless explicitly stated.  By downloading this file you agree to 
+ * comply with these terms.
+ *
+ * If you wish to use any of this code for commercial purposes then 
+ * please email researchcontracts.engineering@imperial.ac.uk.
+ *
+ */
+
+#include "SegmentationScheduler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <Eigen/LU>
+
+SegmentationScheduler::SegmentationScheduler(const float maxTranslation,
+                                             const float maxRotation,
+                                             const float maxUnlabeled,
+                                             const int maxInterval)
+ : maxTranslation(maxTranslation),
+   maxRotation(maxRotation),
+   maxUnlabeled(maxUnlabeled),
+   maxInterval(maxInterval),
+   lastTick(-1),
+   lastPose(Eigen::Matrix4f::Identity()),
+   segmented(0),
+   propagated(0)
+{
+
+}
+
+bool SegmentationScheduler::shouldSegment(const int tick, const Eigen::Matrix4f & pose, const float unlabeled, const bool novel)
+{
+    bool segment = lastTick < 0 || novel || unlabeled > maxUnlabeled || tick - lastTick >= maxInterval;
+
+    if(!segment)
+    {
+        const Eigen::Matrix4f delta = lastPose.inverse() * pose;
+
+        //Rotation angle from the trace of the relative rotation
+        const float cosAngle = std::min(1.0f, std::max(-1.0f, (delta.topLeftCorner(3, 3).trace() - 1.0f) * 0.5f));
+
+        segment = delta.topRightCorner(3, 1).norm() > maxTranslation || std::acos(cosAngle) > maxRotation;
+    }
+
+    if(segment)
+    {
+        lastTick = tick;
+        lastPose = pose;
+        segmented++;
+    }
+    else
+    {
+        propagated++;
+    }
+
+    return segment;
+}
+
+float SegmentationScheduler::unlabeledFraction(const Img<Eigen::Vector4f> & vertices, const Img<Eigen::Vector4f> & colorTime)
+{
+    int valid = 0;
+    int unlabeled = 0;
+
+    for(int i = 0; i < vertices.rows; i++)
+    {
+        for(int j = 0; j < vertices.cols; j++)
+        {
+            if(vertices.at<Eigen::Vector4f>(i, j)(2) > 0)
+            {
+                valid++;
+
+                if((int)colorTime.at<Eigen::Vector4f>(i, j)(1) == 0)
+                {
+                    unlabeled++;
+                }
+            }
+        }
+    }
+
+    return valid > 0 ? (float)unlabeled / (float)valid : 0.0f;
+}
+
+const int & SegmentationScheduler::getSegmented() const
+{
+    return segmented;
+}
+
+const int & SegmentationScheduler::getPropagated() const
+{
+    return propagated;
+}
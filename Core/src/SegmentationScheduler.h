@@ -0,0 +1,68 @@
+/*
+ * This file is part of ElasticFusion.
+ *
+ * Copyright (C) 2015 Imperial College London
+ * 
+ * The use of the code within this file and all code within files that 
+ * make up the software that is ElasticFusion is permitted for 
+ * non-commercial purposes only.  The full terms and conditions that 
+ * apply to the code within this file are detailed within the LICENSE.txt 
+ * file and at <http://www.imperial.ac.uk/dyson-robotics-lab/downloads/elastic-fusion/elastic-fusion-license/> 
+ * unless explicitly stated.  By downloading this file you agree to 
+ * comply with these terms.
+ *
+ * If you wish to use any of this code for commercial purposes then 
+ * please email researchcontracts.engineering@imperial.ac.uk.
+ *
+ */
+
+#ifndef SEGMENTATIONSCHEDULER_H_
+#define SEGMENTATIONSCHEDULER_H_
+
+#include <Eigen/Core>
+
+#include "Utils/Img.h"
+
+/**
+ * Decides which frames get a full LCCP segmentation. In between, labels are taken
+ * from the model prediction, which is what a slow handheld scan mostly needs.
+ */
+class SegmentationScheduler
+{
+    public:
+        SegmentationScheduler(const float maxTranslation = 0.1f,
+                              const float maxRotation = 10.0f * 3.14159265f / 180.0f,
+                              const float maxUnlabeled = 0.25f,
+                              const int maxInterval = 30);
+
+        /**
+         * Segment if the fern database just took a new keyframe, the camera moved far enough since the
+         * last segmentation, too much of the frame has no predicted label or it has been too long
+         * @param novel whether the previous frame was added to the fern database
+         * @param unlabeled fraction of the valid pixels without a predicted label
+         */
+        bool shouldSegment(const int tick, const Eigen::Matrix4f & pose, const float unlabeled, const bool novel);
+
+        /**
+         * Fraction of pixels with depth whose model predicted label (channel 1 of colorTime) is 0
+         */
+        static float unlabeledFraction(const Img<Eigen::Vector4f> & vertices, const Img<Eigen::Vector4f> & colorTime);
+
+        const int & getSegmented() const;
+
+        const int & getPropagated() const;
+
+    private:
+        const float maxTranslation;
+        const float maxRotation;
+        const float maxUnlabeled;
+        const int maxInterval;
+
+        int lastTick;
+        Eigen::Matrix4f lastPose;
+
+        int segmented;
+        int propagated;
+};
+
+#endif /* SEGMENTATIONSCHEDULER_H_ */
@@ -0,0 +1,174 @@
+/*
+ * This file is part of ElasticFusion.
+ *
+ * Copyright (C) 2015 Imperial College London
+ * 
+ * The use of the code within this file and all code within files that 
+ * make up the software that is ElasticFusion is permitted for 
+ * non-commercial purposes only.  The full terms and conditions that 
+ * apply to the code within this file are detailed within the LICENSE.txt 
+ * file and at <http://www.imperial.ac.uk/dyson-robotics-lab/downloads/elastic-fusion/elastic-fusion-license/> 
+ * unless explicitly stated.  By downloading this file you agree to 
+ * comply with these terms.
+ *
+ * If you wish to use any of this code for commercial purposes then 
+ * please email researchcontracts.engineering@imperial.ac.uk.
+ *
+ */
+
+#include "SegmentationWorker.h"
+
+#include <algorithm>
+#include <limits>
+#include <Eigen/LU>
+
+SegmentationWorker::SegmentationWorker(const size_t queueSize)
+ : queueSize(std::max<size_t>(queueSize, 1)),
+   done(false),
+   dropped(0),
+   front(0),
+   thread(&SegmentationWorker::run, this)
+{
+
+}
+
+SegmentationWorker::~SegmentationWorker()
+{
+    {
+        std::unique_lock<std::mutex> lock(queueMutex);
+        done = true;
+    }
+
+    queueCondition.notify_one();
+    thread.join();
+}
+
+void SegmentationWorker::submit(const int tick,
+                                const Eigen::Matrix4f & pose,
+                                pcl::PointCloud<pcl::PointXYZRGB>::Ptr cloud,
+                                pcl::PointCloud<pcl::Normal>::Ptr normals)
+{
+    Job job;
+    job.tick = tick;
+    job.pose = pose;
+    job.cloud = cloud;
+    job.normals = normals;
+
+    {
+        std::unique_lock<std::mutex> lock(queueMutex);
+
+        //Stale frames are not worth segmenting, keep the newest ones
+        while(queue.size() >= queueSize)
+        {
+            queue.pop_front();
+            dropped++;
+        }
+
+        queue.push_back(job);
+    }
+
+    queueCondition.notify_one();
+}
+
+bool SegmentationWorker::getLatest(Result & result)
+{
+    std::unique_lock<std::mutex> lock(resultMutex);
+
+    if(results[front].tick <= result.tick)
+    {
+        return false;
+    }
+
+    result = results[front];
+
+    return true;
+}
+
+void SegmentationWorker::reproject(const Result & result, const Eigen::Matrix4f & pose, float * labels)
+{
+    const int width = Resolution::getInstance().width();
+    const int height = Resolution::getInstance().height();
+    const float fx = Intrinsics::getInstance().fx();
+    const float fy = Intrinsics::getInstance().fy();
+    const float cx = Intrinsics::getInstance().cx();
+    const float cy = Intrinsics::getInstance().cy();
+
+    std::fill(labels, labels + width * height, 0.0f);
+    reprojectDepth.assign(width * height, std::numeric_limits<float>::max());
+
+    if(!result.cloud)
+    {
+        return;
+    }
+
+    //Source camera to current camera
+    const Eigen::Matrix4f relative = pose.inverse() * result.pose;
+    const Eigen::Matrix3f rotation = relative.topLeftCorner(3, 3);
+    const Eigen::Vector3f translation = relative.topRightCorner(3, 1);
+
+    for(size_t i = 0; i < result.labels.size(); i++)
+    {
+        const pcl::PointXYZRGB & point = result.cloud->points[i];
+
+        if(result.labels[i] == 0 || !(point.z > 0))
+        {
+            continue;
+        }
+
+        const Eigen::Vector3f p = rotation * point.getVector3fMap() + translation;
+
+        if(p(2) <= 0)
+        {
+            continue;
+        }
+
+        const int u = (int)(fx * p(0) / p(2) + cx + 0.5f);
+        const int v = (int)(fy * p(1) / p(2) + cy + 0.5f);
+
+        if(u < 0 || u >= width || v < 0 || v >= height || p(2) >= reprojectDepth[v * width + u])
+        {
+            continue;
+        }
+
+        reprojectDepth[v * width + u] = p(2);
+        labels[v * width + u] = result.labels[i];
+    }
+}
+
+int SegmentationWorker::getDropped()
+{
+    std::unique_lock<std::mutex> lock(queueMutex);
+    return dropped;
+}
+
+void SegmentationWorker::run()
+{
+    while(true)
+    {
+        Job job;
+
+        {
+            std::unique_lock<std::mutex> lock(queueMutex);
+            queueCondition.wait(lock, [this]{ return done || !queue.empty(); });
+
+            if(done)
+            {
+                return;
+            }
+
+            job = queue.front();
+            queue.pop_front();
+        }
+
+        //Only this thread writes the back buffer and flips front, so it can be filled without the lock
+        Result & back = results[1 - front];
+        back.labels.resize(job.cloud->size());
+        segmenter.mySeg(job.cloud, job.normals, back.labels.data());
+        back.tick = job.tick;
+        back.pose = job.pose;
+        back.cloud = job.cloud;
+
+        std::unique_lock<std::mutex> lock(resultMutex);
+        front = 1 - front;
+    }
+}
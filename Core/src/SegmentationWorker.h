@@ -0,0 +1,122 @@
+/*
+ * This file is part of ElasticFusion.
+ *
+ * Copyright (C) 2015 Imperial College London
+ * 
+ * The use of the code within this file and all code within files that 
+ * make up the software that is ElasticFusion is permitted for 
+ * non-commercial purposes only.  The full terms and conditions that 
+ * apply to the code within this file are detailed within the LICENSE.txt 
+ * file and at <http://www.imperial.ac.uk/dyson-robotics-lab/downloads/elastic-fusion/elastic-fusion-license/> 
+ * unless explicitly stated.  By downloading this file you agree to 
+ * comply with these terms.
+ *
+ * If you wish to use any of this code for commercial purposes then 
+ * please email researchcontracts.engineering@imperial.ac.uk.
+ *
+ */
+
+#ifndef SEGMENTATIONWORKER_H_
+#define SEGMENTATIONWORKER_H_
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <Eigen/Core>
+#include <Eigen/StdDeque>
+
+#include "Utils/Intrinsics.h"
+#include "Utils/Resolution.h"
+#include "myLccp.h"
+
+/**
+ * Runs the LCCP segmentation on its own thread so tracking does not wait for it.
+ * Frames go in through a bounded queue that drops the oldest frame when it is full,
+ * results come out of a double buffer tagged with the tick and pose of their frame.
+ */
+class SegmentationWorker
+{
+    public:
+        class Result
+        {
+            public:
+                Result()
+                 : tick(-1),
+                   pose(Eigen::Matrix4f::Identity())
+                {}
+
+                int tick;
+                Eigen::Matrix4f pose;
+
+                //Camera frame points of the segmented frame
+                pcl::PointCloud<pcl::PointXYZRGB>::Ptr cloud;
+
+                //Segment label of every pixel, 0 where there is no depth
+                std::vector<float> labels;
+
+                EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+        };
+
+        SegmentationWorker(const size_t queueSize = 1);
+
+        virtual ~SegmentationWorker();
+
+        /**
+         * Queues a frame for segmentation, dropping the oldest queued frame if the queue is full.
+         * The clouds must be in the camera frame and are not modified afterwards.
+         */
+        void submit(const int tick,
+                    const Eigen::Matrix4f & pose,
+                    pcl::PointCloud<pcl::PointXYZRGB>::Ptr cloud,
+                    pcl::PointCloud<pcl::Normal>::Ptr normals);
+
+        /**
+         * Copies the most recent finished result into result
+         * @return true if it is newer than result.tick
+         */
+        bool getLatest(Result & result);
+
+        /**
+         * Forward projects the labels of result into the camera at pose, the nearest surface wins
+         * @param labels one label per pixel, pixels nothing projects to get 0
+         */
+        void reproject(const Result & result, const Eigen::Matrix4f & pose, float * labels);
+
+        int getDropped();
+
+    private:
+        class Job
+        {
+            public:
+                int tick;
+                Eigen::Matrix4f pose;
+                pcl::PointCloud<pcl::PointXYZRGB>::Ptr cloud;
+                pcl::PointCloud<pcl::Normal>::Ptr normals;
+
+                EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+        };
+
+        void run();
+
+        myLccp segmenter;
+
+        std::mutex queueMutex;
+        std::condition_variable queueCondition;
+        std::deque<Job, Eigen::aligned_allocator<Job> > queue;
+        const size_t queueSize;
+        bool done;
+        int dropped;
+
+        //The worker fills results[1 - front] and then flips front, readers only see results[front]
+        std::mutex resultMutex;
+        Result results[2];
+        int front;
+
+        std::vector<float> reprojectDepth;
+
+        std::thread thread;
+};
+
+#endif /* SEGMENTATIONWORKER_H_ */
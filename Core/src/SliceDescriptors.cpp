@@ -0,0 +1,134 @@
+/*
+ * This file is part of ElasticFusion.
+ *
+ * Copyright (C) 2015 Imperial College London
+ * 
+ * The use of the code within this file and all code within files that 
+ * make up the software that is ElasticFusion is permitted for 
+ * non-commercial purposes only.  The full terms and conditions that 
+ * apply to the code within this file are detailed within the LICENSE.txt 
+ * file and at <http://www.imperial.ac.uk/dyson-robotics-lab/downloads/elastic-fusion/elastic-fusion-license/> 
+ * unless explicitly stated.  By downloading this file you agree to 
+ * comply with these terms.
+ *
+ * If you wish to use any of this code for commercial purposes then 
+ * please email researchcontracts.engineering@imperial.ac.uk.
+ *
+ */
+
+#include "SliceDescriptors.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "Utils/Parallel.h"
+
+//A point is on a cut within this fraction of the slice thickness
+static const float sliceTolerance = 0.025f;
+
+//A point is on an axis within this distance and on a diagonal within this difference of slope
+static const float axisTolerance = 0.001f;
+static const float slopeTolerance = 0.01f;
+
+SliceDescriptors::SliceDescriptors(const int numSlices, const unsigned int numThreads)
+ : numSlices(numSlices),
+   numThreads(Parallel::threadCount(numThreads)),
+   numDescriptors(0)
+{
+
+}
+
+void SliceDescriptors::compute(const SurfelSegments & segments, const SegmentBoxes & boxes)
+{
+    const int dims = dimensions();
+
+    numDescriptors = segments.size();
+    descriptors.assign(numDescriptors * dims, 0.0f);
+
+    Parallel::forRange(0, numDescriptors, numThreads, [&](const size_t begin, const size_t end, const unsigned int)
+    {
+        for(size_t segment = begin; segment < end; segment++)
+        {
+            const SegmentBoxes::Box & box = boxes.box(segment);
+            float * descriptor = &descriptors[segment * dims];
+
+            const float thickness = (box.max(2) - box.min(2)) / numSlices;
+
+            if(!(thickness > 0))
+            {
+                continue;
+            }
+
+            const float invThickness = 1.0f / thickness;
+            const float halfWidth = box.max(0);
+            const float halfHeight = box.max(1);
+
+            for(uint32_t i = segments.begin(segment); i < segments.end(segment); i++)
+            {
+                const Eigen::Vector3f offset = Eigen::Vector3f(segments.x[i], segments.y[i], segments.z[i]) - box.position;
+
+                //Nearest cut, cuts 1 to numSlices - 1 lie inside the box
+                const float depth = (offset.dot(box.rotation.col(2)) - box.min(2)) * invThickness;
+                const int cut = (int)std::floor(depth + 0.5f);
+
+                if(cut < 1 || cut >= numSlices || std::fabs(depth - cut) >= sliceTolerance)
+                {
+                    continue;
+                }
+
+                const float u = offset.dot(box.rotation.col(0));
+                const float v = offset.dot(box.rotation.col(1));
+
+                //Slope of the point against the slope of the diagonals, without dividing. The slope is the same at
+                //both ends of a diagonal, so like in the templates both ends go to sectors 1 and 3 and 5 and 7 stay empty
+                const float cross = std::fabs(u) * halfWidth * slopeTolerance;
+                const bool rising = std::fabs(v * halfWidth - halfHeight * u) < cross;
+                const bool falling = std::fabs(v * halfWidth + halfHeight * u) < cross;
+
+                int sector;
+
+                if(std::fabs(u) <= axisTolerance && v > 0)
+                {
+                    sector = 0;
+                }
+                else if(rising)
+                {
+                    sector = 1;
+                }
+                else if(std::fabs(v) <= axisTolerance && u > 0)
+                {
+                    sector = 2;
+                }
+                else if(falling)
+                {
+                    sector = 3;
+                }
+                else if(std::fabs(u) <= axisTolerance && v < 0)
+                {
+                    sector = 4;
+                }
+                else if(std::fabs(v) <= axisTolerance && u < 0)
+                {
+                    sector = 6;
+                }
+                else
+                {
+                    continue;
+                }
+
+                //Angle between the normal and the direction to the centre, the same in any frame
+                const float length = offset.norm();
+
+                if(length == 0)
+                {
+                    continue;
+                }
+
+                const float cosine = -(segments.nx[i] * offset(0) + segments.ny[i] * offset(1) + segments.nz[i] * offset(2)) / length;
+
+                //Points come in surfel order, the last one of a bin sets its value as it did in the templates
+                descriptor[(cut - 1) * numSectors + sector] = (float)(std::acos(std::max(-1.0f, std::min(1.0f, cosine))) * 180.0 / 3.14159265358979);
+            }
+        }
+    }, 1);
+}
@@ -0,0 +1,79 @@
+/*
+ * This file is part of ElasticFusion.
+ *
+ * Copyright (C) 2015 Imperial College London
+ * 
+ * The use of the code within this file and all code within files that 
+ * make up the software that is ElasticFusion is permitted for 
+ * non-commercial purposes only.  The full terms and conditions that 
+ * apply to the code within this file are detailed within the LICENSE.txt 
+ * file and at <http://www.imperial.ac.uk/dyson-robotics-lab/downloads/elastic-fusion/elastic-fusion-license/> 
+ * unless explicitly stated.  By downloading this file you agree to 
+ * comply with these terms.
+ *
+ * If you wish to use any of this code for commercial purposes then 
+ * please email researchcontracts.engineering@imperial.ac.uk.
+ *
+ */
+
+#ifndef SLICEDESCRIPTORS_H_
+#define SLICEDESCRIPTORS_H_
+
+#include <vector>
+
+#include "SurfelSegments.h"
+#include "SegmentBoxes.h"
+
+/**
+ * Slice angle descriptor of every segment. The box of the segment is cut across its minor axis at
+ * numSlices - 1 planes and, on each cut, the points lying along the eight directions from the centre
+ * (clockwise from the middle axis, alternating between the axes and the box diagonals) give the angle
+ * between their normal and the direction back to the centre. Eight values per cut with the values of
+ * the object template files, so a template can be compared with any cut.
+ */
+class SliceDescriptors
+{
+    public:
+        static const int numSectors = 8;
+
+        //Bumped whenever the values change, templates of another version are not comparable
+        static const uint32_t version = 1;
+
+        SliceDescriptors(const int numSlices = 6, const unsigned int numThreads = 0);
+
+        /**
+         * Every point is binned into its cut and sector in its box frame in one pass. A bin takes the angle
+         * of its last point in surfel order and is zero when it has none
+         */
+        void compute(const SurfelSegments & segments, const SegmentBoxes & boxes);
+
+        size_t size() const
+        {
+            return numDescriptors;
+        }
+
+        int dimensions() const
+        {
+            return (numSlices - 1) * numSectors;
+        }
+
+        const float * descriptor(const size_t segment) const
+        {
+            return &descriptors[segment * dimensions()];
+        }
+
+        //All descriptors back to back
+        const float * data() const
+        {
+            return descriptors.data();
+        }
+
+    private:
+        const int numSlices;
+        const unsigned int numThreads;
+
+        size_t numDescriptors;
+        std::vector<float> descriptors;
+};
+
+#endif /* SLICEDESCRIPTORS_H_ */
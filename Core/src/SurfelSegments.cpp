@@ -0,0 +1,142 @@
+/*
+ * This file is part of ElasticFusion.
+ *
+ * Copyright (C) 2015 Imperial College London
+ * 
+ * The use of the code within this file and all code within files that 
+ * make up the software that is ElasticFusion is permitted for 
+ * non-commercial purposes only.  The full terms and conditions that 
+ * apply to the code within this file are detailed within the LICENSE.txt 
+ * file and at <http://www.imperial.ac.uk/dyson-robotics-lab/downloads/elastic-fusion/elastic-fusion-license/> 
+ * unless explicitly stated.  By downloading this file you agree to 
+ * comply with these terms.
+ *
+ * If you wish to use any of this code for commercial purposes then 
+ * please email researchcontracts.engineering@imperial.ac.uk.
+ *
+ */
+
+#include "SurfelSegments.h"
+
+#include <algorithm>
+
+#include "Utils/LabelIndex.h"
+#include "Utils/Parallel.h"
+
+static const size_t grain = 4096;
+
+SurfelSegments::SurfelSegments(const unsigned int numThreads)
+ : numThreads(Parallel::threadCount(numThreads))
+{
+
+}
+
+void SurfelSegments::extract(const Eigen::Vector4f * surfels, const size_t count)
+{
+    labels.clear();
+    offsets.assign(1, 0);
+
+    x.resize(count);
+    y.resize(count);
+    z.resize(count);
+    nx.resize(count);
+    ny.resize(count);
+    nz.resize(count);
+    surfel.resize(count);
+
+    if(count == 0)
+    {
+        return;
+    }
+
+    chunkMax.assign(numThreads, 0);
+
+    Parallel::forRange(0, count, numThreads, [&](const size_t begin, const size_t end, const unsigned int chunk)
+    {
+        int maxLabel = 0;
+
+        for(size_t i = begin; i < end; i++)
+        {
+            maxLabel = std::max(maxLabel, LabelIndex::of(surfels[i * 3 + 1](1)));
+        }
+
+        chunkMax[chunk] = maxLabel;
+    }, grain);
+
+    const size_t numLabels = *std::max_element(chunkMax.begin(), chunkMax.end()) + 1;
+
+    //Histogram and first surfel of every label, per chunk
+    chunkCount.assign(numThreads * numLabels, 0);
+    chunkFirst.assign(numThreads * numLabels, -1);
+
+    Parallel::forRange(0, count, numThreads, [&](const size_t begin, const size_t end, const unsigned int chunk)
+    {
+        uint32_t * histogram = &chunkCount[chunk * numLabels];
+        int64_t * first = &chunkFirst[chunk * numLabels];
+
+        for(size_t i = begin; i < end; i++)
+        {
+            const int label = LabelIndex::of(surfels[i * 3 + 1](1));
+
+            if(histogram[label]++ == 0)
+            {
+                first[label] = i;
+            }
+        }
+    }, grain);
+
+    order.clear();
+
+    for(size_t label = 0; label < numLabels; label++)
+    {
+        for(unsigned int chunk = 0; chunk < numThreads; chunk++)
+        {
+            if(chunkFirst[chunk * numLabels + label] >= 0)
+            {
+                order.push_back(std::make_pair(chunkFirst[chunk * numLabels + label], (int)label));
+                break;
+            }
+        }
+    }
+
+    std::sort(order.begin(), order.end());
+
+    //Prefix sums over segments, then over chunks inside a segment, turn the histograms into write positions
+    uint32_t offset = 0;
+
+    for(size_t segment = 0; segment < order.size(); segment++)
+    {
+        const int label = order[segment].second;
+
+        labels.push_back(label);
+
+        for(unsigned int chunk = 0; chunk < numThreads; chunk++)
+        {
+            const uint32_t chunkSize = chunkCount[chunk * numLabels + label];
+            chunkCount[chunk * numLabels + label] = offset;
+            offset += chunkSize;
+        }
+
+        offsets.push_back(offset);
+    }
+
+    Parallel::forRange(0, count, numThreads, [&](const size_t begin, const size_t end, const unsigned int chunk)
+    {
+        uint32_t * position = &chunkCount[chunk * numLabels];
+
+        for(size_t i = begin; i < end; i++)
+        {
+            const Eigen::Vector4f & pos = surfels[i * 3];
+            const Eigen::Vector4f & normal = surfels[i * 3 + 2];
+            const uint32_t target = position[LabelIndex::of(surfels[i * 3 + 1](1))]++;
+
+            x[target] = pos(0);
+            y[target] = pos(1);
+            z[target] = pos(2);
+            nx[target] = normal(0);
+            ny[target] = normal(1);
+            nz[target] = normal(2);
+            surfel[target] = i;
+        }
+    }, grain);
+}
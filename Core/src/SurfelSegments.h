@@ -0,0 +1,86 @@
+/*
+ * This file is part of ElasticFusion.
+ *
+ * Copyright (C) 2015 Imperial College London
+ * 
+ * The use of the code within this file and all code within files that 
+ * make up the software that is ElasticFusion is permitted for 
+ * non-commercial purposes only.  The full terms and conditions that 
+ * apply to the code within this file are detailed within the LICENSE.txt 
+ * file and at <http://www.imperial.ac.uk/dyson-robotics-lab/downloads/elastic-fusion/elastic-fusion-license/> 
+ * unless explicitly stated.  By downloading this file you agree to 
+ * comply with these terms.
+ *
+ * If you wish to use any of this code for commercial purposes then 
+ * please email researchcontracts.engineering@imperial.ac.uk.
+ *
+ */
+
+#ifndef SURFELSEGMENTS_H_
+#define SURFELSEGMENTS_H_
+
+#include <cstddef>
+#include <stdint.h>
+#include <vector>
+#include <Eigen/Core>
+
+/**
+ * Groups surfels by label with a counting sort. Every segment is a contiguous span of one structure of arrays
+ * buffer, segments are ordered by the first surfel that carries their label and surfels keep their order inside
+ * a segment, which is exactly what appending surfel by surfel to a list of per label clouds gives.
+ * Surfels whose label is not a valid index (see LabelIndex) go with label 0.
+ */
+class SurfelSegments
+{
+    public:
+        SurfelSegments(const unsigned int numThreads = 0);
+
+        /**
+         * @param surfels laid out as GlobalModel::downloadMap returns them: position, colour (label in y), normal
+         */
+        void extract(const Eigen::Vector4f * surfels, const size_t count);
+
+        size_t size() const
+        {
+            return labels.size();
+        }
+
+        int label(const size_t segment) const
+        {
+            return labels[segment];
+        }
+
+        //Span [begin(segment), end(segment)) of the arrays below
+        uint32_t begin(const size_t segment) const
+        {
+            return offsets[segment];
+        }
+
+        uint32_t end(const size_t segment) const
+        {
+            return offsets[segment + 1];
+        }
+
+        uint32_t count(const size_t segment) const
+        {
+            return offsets[segment + 1] - offsets[segment];
+        }
+
+        //Surfel attributes sorted by segment, and the index of each in the input
+        std::vector<float> x, y, z;
+        std::vector<float> nx, ny, nz;
+        std::vector<uint32_t> surfel;
+
+    private:
+        const unsigned int numThreads;
+
+        std::vector<int> labels;
+        std::vector<uint32_t> offsets;
+
+        std::vector<int> chunkMax;
+        std::vector<uint32_t> chunkCount;
+        std::vector<int64_t> chunkFirst;
+        std::vector<std::pair<int64_t, int> > order;
+};
+
+#endif /* SURFELSEGMENTS_H_ */
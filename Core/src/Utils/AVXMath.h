@@ -0,0 +1,111 @@
+/*
+ * This file is part of ElasticFusion.
+ *
+ * Copyright (C) 2015 Imperial College London
+ *
+ * The use of the code within this file and all code within files that
+ * make up the software that is ElasticFusion is permitted for
+ * non-commercial purposes only.  The full terms and conditions that
+ * apply to the code within this file are detailed within the LICENSE.txt
+ * file and at <http://www.imperial.ac.uk/dyson-robotics-lab/downloads/elastic-fusion/elastic-fusion-license/>
+ * unless explicitly stated.  By downloading this file you agree to
+ * comply with these terms.
+ *
+ * If you wish to use any of this code for commercial purposes then
+ * please email researchcontracts.engineering@imperial.ac.uk.
+ *
+ */
+
+#ifndef UTILS_AVXMATH_H_
+#define UTILS_AVXMATH_H_
+
+#ifdef __AVX__
+
+#include <immintrin.h>
+
+/**
+ * Eight lane counterparts of SSEMath with the same polynomials, so both paths agree to float rounding
+ */
+class AVXMath
+{
+    public:
+        static inline __m256 dot(const __m256 ax, const __m256 ay, const __m256 az,
+                                 const __m256 bx, const __m256 by, const __m256 bz)
+        {
+            return _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(ax, bx), _mm256_mul_ps(ay, by)), _mm256_mul_ps(az, bz));
+        }
+
+        static inline __m256 abs(const __m256 x)
+        {
+            return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), x);
+        }
+
+        static inline __m256 select(const __m256 mask, const __m256 a, const __m256 b)
+        {
+            return _mm256_blendv_ps(b, a, mask);
+        }
+
+        /**
+         * Arc cosine in radians, Abramowitz & Stegun 4.4.46, absolute error below 2e-8 on [-1, 1]
+         * @param x is clamped to [-1, 1]
+         */
+        static inline __m256 acos(const __m256 x)
+        {
+            const __m256 one = _mm256_set1_ps(1.0f);
+            const __m256 clamped = _mm256_max_ps(_mm256_set1_ps(-1.0f), _mm256_min_ps(one, x));
+            const __m256 negative = _mm256_cmp_ps(clamped, _mm256_setzero_ps(), _CMP_LT_OQ);
+            const __m256 a = abs(clamped);
+
+            __m256 poly = _mm256_set1_ps(-0.0012624911f);
+            poly = _mm256_add_ps(_mm256_mul_ps(poly, a), _mm256_set1_ps(0.0066700901f));
+            poly = _mm256_add_ps(_mm256_mul_ps(poly, a), _mm256_set1_ps(-0.0170881256f));
+            poly = _mm256_add_ps(_mm256_mul_ps(poly, a), _mm256_set1_ps(0.0308918810f));
+            poly = _mm256_add_ps(_mm256_mul_ps(poly, a), _mm256_set1_ps(-0.0501743046f));
+            poly = _mm256_add_ps(_mm256_mul_ps(poly, a), _mm256_set1_ps(0.0889789874f));
+            poly = _mm256_add_ps(_mm256_mul_ps(poly, a), _mm256_set1_ps(-0.2145988016f));
+            poly = _mm256_add_ps(_mm256_mul_ps(poly, a), _mm256_set1_ps(1.5707963050f));
+
+            const __m256 result = _mm256_mul_ps(_mm256_sqrt_ps(_mm256_sub_ps(one, a)), poly);
+
+            // acos(-x) = pi - acos(x)
+            return select(negative, _mm256_sub_ps(_mm256_set1_ps(3.14159265358979f), result), result);
+        }
+
+        /**
+         * Natural exponential, Cephes polynomial with a relative error of about 1e-7
+         * @param x is clamped to the range representable as a float
+         */
+        static inline __m256 exp(const __m256 x)
+        {
+            const __m256 one = _mm256_set1_ps(1.0f);
+            const __m256 clamped = _mm256_max_ps(_mm256_set1_ps(-88.3762626647949f), _mm256_min_ps(_mm256_set1_ps(88.3762626647949f), x));
+
+            // Split into n * ln(2) + r with n = round(x / ln(2))
+            const __m256 fx = _mm256_add_ps(_mm256_mul_ps(clamped, _mm256_set1_ps(1.44269504088896341f)), _mm256_set1_ps(0.5f));
+            const __m256 floored = _mm256_floor_ps(fx);
+
+            __m256 r = _mm256_sub_ps(clamped, _mm256_mul_ps(floored, _mm256_set1_ps(0.693359375f)));
+            r = _mm256_sub_ps(r, _mm256_mul_ps(floored, _mm256_set1_ps(-2.12194440e-4f)));
+
+            __m256 poly = _mm256_set1_ps(1.9875691500e-4f);
+            poly = _mm256_add_ps(_mm256_mul_ps(poly, r), _mm256_set1_ps(1.3981999507e-3f));
+            poly = _mm256_add_ps(_mm256_mul_ps(poly, r), _mm256_set1_ps(8.3334519073e-3f));
+            poly = _mm256_add_ps(_mm256_mul_ps(poly, r), _mm256_set1_ps(4.1665795894e-2f));
+            poly = _mm256_add_ps(_mm256_mul_ps(poly, r), _mm256_set1_ps(1.6666665459e-1f));
+            poly = _mm256_add_ps(_mm256_mul_ps(poly, r), _mm256_set1_ps(5.0000001201e-1f));
+            poly = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(poly, _mm256_mul_ps(r, r)), r), one);
+
+            // Scale by 2^n by building the exponent bits, AVX has no 256 bit integer arithmetic so per half
+            const __m256i n = _mm256_cvttps_epi32(floored);
+            const __m128i bias = _mm_set1_epi32(127);
+            const __m128i low = _mm_slli_epi32(_mm_add_epi32(_mm256_castsi256_si128(n), bias), 23);
+            const __m128i high = _mm_slli_epi32(_mm_add_epi32(_mm256_extractf128_si256(n, 1), bias), 23);
+            const __m256i exponent = _mm256_insertf128_si256(_mm256_castsi128_si256(low), high, 1);
+
+            return _mm256_mul_ps(poly, _mm256_castsi256_ps(exponent));
+        }
+};
+
+#endif /* __AVX__ */
+
+#endif /* UTILS_AVXMATH_H_ */
@@ -0,0 +1,38 @@
+/*
+ * This file is part of ElasticFusion.
+ *
+ * Copyright (C) 2015 Imperial College London
+ * 
+ * The use of the code within this file and all code within files that 
+ * make up the software that is ElasticFusion is permitted for 
+ * non-commercial purposes only.  The full terms and conditions that 
+ * apply to the code within this file are detailed within the LICENSE.txt 
+ * file and at <http://www.imperial.ac.uk/dyson-robotics-lab/downloads/elastic-fusion/elastic-fusion-license/> 
+ * unless explicitly stated.  By downloading this file you agree to 
+ * comply with these terms.
+ *
+ * If you wish to use any of this code for commercial purposes then 
+ * please email researchcontracts.engineering@imperial.ac.uk.
+ *
+ */
+
+#ifndef UTILS_LABELINDEX_H_
+#define UTILS_LABELINDEX_H_
+
+/**
+ * Labels travel as floats in the label images and the model, the dense tables indexed by them
+ * only take whole numbers from 0 to max. Anything else, NaN, negative or too large, reads as 0, unlabeled.
+ */
+class LabelIndex
+{
+    public:
+        //Floats hold every integer up to 2^24 exactly
+        static const int max = (1 << 24) - 1;
+
+        static inline int of(const float value)
+        {
+            return value >= 0 && value <= (float)max ? (int)value : 0;
+        }
+};
+
+#endif /* UTILS_LABELINDEX_H_ */
@@ -0,0 +1,203 @@
+/*
+ * This file is part of ElasticFusion.
+ *
+ * Copyright (C) 2015 Imperial College London
+ * 
+ * The use of the code within this file and all code within files that 
+ * make up the software that is ElasticFusion is permitted for 
+ * non-commercial purposes only.  The full terms and conditions that 
+ * apply to the code within this file are detailed within the LICENSE.txt 
+ * file and at <http://www.imperial.ac.uk/dyson-robotics-lab/downloads/elastic-fusion/elastic-fusion-license/> 
+ * unless explicitly stated.  By downloading this file you agree to 
+ * comply with these terms.
+ *
+ * If you wish to use any of this code for commercial purposes then 
+ * please email researchcontracts.engineering@imperial.ac.uk.
+ *
+ */
+
+#ifndef UTILS_LABELPYRAMID_H_
+#define UTILS_LABELPYRAMID_H_
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
+#include <pcl/point_cloud.h>
+#include <pcl/point_types.h>
+
+/**
+ * Moves organized frames down a level of a 2x pyramid for segmentation and the resulting labels back up.
+ * The supervoxel seeds are several centimetres apart, so the full resolution grid mostly repeats itself.
+ */
+class LabelPyramid
+{
+    public:
+        /**
+         * Keeps one pixel of every 2^level x 2^level block: the centre pixel if it has depth, otherwise the closest valid one
+         * @param normals may be empty, then coarseNormals is left empty too
+         */
+        template<typename PointT>
+        static void downsample(const pcl::PointCloud<PointT> & input,
+                               const pcl::PointCloud<pcl::Normal>::ConstPtr & normals,
+                               const int level,
+                               pcl::PointCloud<PointT> & coarse,
+                               pcl::PointCloud<pcl::Normal> & coarseNormals)
+        {
+            const int factor = 1 << level;
+            const int width = (input.width + factor - 1) / factor;
+            const int height = (input.height + factor - 1) / factor;
+            const bool hasNormals = normals && normals->size() == input.size();
+
+            coarse.points.resize(width * height);
+            coarse.width = width;
+            coarse.height = height;
+            coarse.is_dense = false;
+
+            coarseNormals.points.resize(hasNormals ? width * height : 0);
+            coarseNormals.width = hasNormals ? width : 0;
+            coarseNormals.height = hasNormals ? height : 0;
+
+            for(int v = 0; v < height; v++)
+            {
+                for(int u = 0; u < width; u++)
+                {
+                    const int rowEnd = std::min<int>((v + 1) * factor, input.height);
+                    const int colEnd = std::min<int>((u + 1) * factor, input.width);
+                    const int centre = std::min(v * factor + factor / 2, rowEnd - 1) * input.width + std::min(u * factor + factor / 2, colEnd - 1);
+
+                    int best = centre;
+
+                    if(!valid(input.points[centre]))
+                    {
+                        float bestDepth = std::numeric_limits<float>::max();
+
+                        for(int row = v * factor; row < rowEnd; row++)
+                        {
+                            for(int col = u * factor; col < colEnd; col++)
+                            {
+                                const PointT & point = input.points[row * input.width + col];
+
+                                if(valid(point) && point.z < bestDepth)
+                                {
+                                    bestDepth = point.z;
+                                    best = row * input.width + col;
+                                }
+                            }
+                        }
+                    }
+
+                    coarse.points[v * width + u] = input.points[best];
+
+                    if(hasNormals)
+                    {
+                        coarseNormals.points[v * width + u] = normals->points[best];
+                    }
+                }
+            }
+        }
+
+        /**
+         * Gives every valid input pixel the label of the closest labeled coarse point in the 3x3 coarse neighbourhood
+         * around it. Coarse points across a depth discontinuity are not used, pixels without any candidate get 0
+         */
+        template<typename PointT>
+        static void upsample(const pcl::PointCloud<PointT> & input,
+                             const pcl::PointCloud<PointT> & coarse,
+                             const float * coarseLabels,
+                             const int level,
+                             float * labels,
+                             const float depthDiscontinuity = 0.05f)
+        {
+            const int factor = 1 << level;
+
+            for(int row = 0; row < (int)input.height; row++)
+            {
+                for(int col = 0; col < (int)input.width; col++)
+                {
+                    const PointT & point = input.points[row * input.width + col];
+
+                    float label = 0;
+
+                    if(valid(point))
+                    {
+                        const int v = row / factor;
+                        const int u = col / factor;
+                        float bestDistance = std::numeric_limits<float>::max();
+
+                        for(int cv = std::max(v - 1, 0); cv <= std::min<int>(v + 1, coarse.height - 1); cv++)
+                        {
+                            for(int cu = std::max(u - 1, 0); cu <= std::min<int>(u + 1, coarse.width - 1); cu++)
+                            {
+                                const int index = cv * coarse.width + cu;
+                                const PointT & candidate = coarse.points[index];
+
+                                if(coarseLabels[index] == 0 || !valid(candidate) ||
+                                   std::fabs(candidate.z - point.z) > depthDiscontinuity * std::min(candidate.z, point.z))
+                                {
+                                    continue;
+                                }
+
+                                const float distance = (candidate.getVector3fMap() - point.getVector3fMap()).squaredNorm();
+
+                                if(distance < bestDistance)
+                                {
+                                    bestDistance = distance;
+                                    label = coarseLabels[index];
+                                }
+                            }
+                        }
+                    }
+
+                    labels[row * input.width + col] = label;
+                }
+            }
+        }
+
+        /**
+         * Fraction of the pixels labeled in reference whose label in labels maps to the same reference segment,
+         * each segment of labels being mapped to the reference segment it overlaps most
+         */
+        static float agreement(const float * reference, const float * labels, const size_t size)
+        {
+            std::unordered_map<unsigned long long, int> overlap;
+            std::unordered_map<int, int> bestOverlap;
+            int labeled = 0;
+
+            for(size_t i = 0; i < size; i++)
+            {
+                if(reference[i] != 0)
+                {
+                    labeled++;
+
+                    if(labels[i] != 0)
+                    {
+                        const unsigned long long key = ((unsigned long long)(unsigned int)labels[i] << 32) | (unsigned int)reference[i];
+                        const int count = ++overlap[key];
+                        int & best = bestOverlap[(int)labels[i]];
+                        best = std::max(best, count);
+                    }
+                }
+            }
+
+            int agreeing = 0;
+
+            for(std::unordered_map<int, int>::const_iterator it = bestOverlap.begin(); it != bestOverlap.end(); ++it)
+            {
+                agreeing += it->second;
+            }
+
+            return labeled > 0 ? (float)agreeing / (float)labeled : 1.0f;
+        }
+
+    private:
+        template<typename PointT>
+        static bool valid(const PointT & point)
+        {
+            return std::isfinite(point.z) && point.z > 0;
+        }
+};
+
+#endif /* UTILS_LABELPYRAMID_H_ */
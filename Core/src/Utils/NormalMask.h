@@ -0,0 +1,113 @@
+/*
+ * This file is part of ElasticFusion.
+ *
+ * Copyright (C) 2015 Imperial College London
+ * 
+ * The use of the code within this file and all code within files that 
+ * make up the software that is ElasticFusion is permitted for 
+ * non-commercial purposes only.  The full terms and conditions that 
+ * apply to the code within this file are detailed within the LICENSE.txt 
+ * file and at <http://www.imperial.ac.uk/dyson-robotics-lab/downloads/elastic-fusion/elastic-fusion-license/> 
+ * unless explicitly stated.  By downloading this file you agree to 
+ * comply with these terms.
+ *
+ * If you wish to use any of this code for commercial purposes then 
+ * please email researchcontracts.engineering@imperial.ac.uk.
+ *
+ */
+
+#ifndef UTILS_NORMALMASK_H_
+#define UTILS_NORMALMASK_H_
+
+#include <algorithm>
+#include <cfloat>
+#include <cstddef>
+#include <stdint.h>
+#include <vector>
+#include <Eigen/Core>
+
+#include "Parallel.h"
+#include "SSEMath.h"
+
+/**
+ * One bit per pixel, set where two normal maps agree to within an angle. Bit i lives in word i / 32 at position i % 32
+ */
+class NormalMask
+{
+    public:
+        /**
+         * Sets the bit of every pixel whose normals have a dot product above minCos. Pixels where either normal
+         * is zero (no data) or not finite are never set, the angle itself is never computed
+         */
+        static void agreement(const Eigen::Vector4f * a,
+                              const Eigen::Vector4f * b,
+                              const size_t size,
+                              const float minCos,
+                              std::vector<uint32_t> & mask,
+                              const unsigned int numThreads = 0)
+        {
+            mask.assign((size + 31) / 32, 0);
+
+            uint32_t * words = mask.data();
+
+            Parallel::forRange(0, mask.size(), numThreads, [&](const size_t begin, const size_t end, const unsigned int)
+            {
+                for(size_t word = begin; word < end; word++)
+                {
+                    const size_t first = word * 32;
+                    const size_t last = std::min(first + 32, size);
+
+                    uint32_t bits = 0;
+                    size_t i = first;
+
+#ifdef __SSE2__
+                    const __m128 threshold = _mm_set1_ps(minCos);
+                    const __m128 epsilon = _mm_set1_ps(1e-12f);
+                    const __m128 largest = _mm_set1_ps(FLT_MAX);
+
+                    for(; i + 4 <= last; i += 4)
+                    {
+                        //Four pixels to structure of arrays, the fourth component is ignored
+                        __m128 a0 = _mm_loadu_ps(a[i].data()), a1 = _mm_loadu_ps(a[i + 1].data()), a2 = _mm_loadu_ps(a[i + 2].data()), a3 = _mm_loadu_ps(a[i + 3].data());
+                        __m128 b0 = _mm_loadu_ps(b[i].data()), b1 = _mm_loadu_ps(b[i + 1].data()), b2 = _mm_loadu_ps(b[i + 2].data()), b3 = _mm_loadu_ps(b[i + 3].data());
+                        _MM_TRANSPOSE4_PS(a0, a1, a2, a3);
+                        _MM_TRANSPOSE4_PS(b0, b1, b2, b3);
+
+                        const __m128 dot = SSEMath::dot(a0, a1, a2, b0, b1, b2);
+
+                        //Squared lengths in (epsilon, FLT_MAX) rule out zero, infinite and, as ordered comparisons are false for it, NaN
+                        const __m128 lengthA = SSEMath::dot(a0, a1, a2, a0, a1, a2);
+                        const __m128 lengthB = SSEMath::dot(b0, b1, b2, b0, b1, b2);
+                        const __m128 valid = _mm_and_ps(_mm_and_ps(_mm_cmpgt_ps(lengthA, epsilon), _mm_cmplt_ps(lengthA, largest)),
+                                                        _mm_and_ps(_mm_cmpgt_ps(lengthB, epsilon), _mm_cmplt_ps(lengthB, largest)));
+
+                        bits |= (uint32_t)_mm_movemask_ps(_mm_and_ps(valid, _mm_cmpgt_ps(dot, threshold))) << (i - first);
+                    }
+#endif
+
+                    for(; i < last; i++)
+                    {
+                        bits |= (uint32_t)agrees(a[i], b[i], minCos) << (i - first);
+                    }
+
+                    words[word] = bits;
+                }
+            }, 64);
+        }
+
+        static bool test(const uint32_t * mask, const size_t i)
+        {
+            return (mask[i >> 5] >> (i & 31)) & 1;
+        }
+
+    private:
+        static bool agrees(const Eigen::Vector4f & a, const Eigen::Vector4f & b, const float minCos)
+        {
+            const float lengthA = a.head<3>().squaredNorm();
+            const float lengthB = b.head<3>().squaredNorm();
+
+            return lengthA > 1e-12f && lengthA < FLT_MAX && lengthB > 1e-12f && lengthB < FLT_MAX && a.head<3>().dot(b.head<3>()) > minCos;
+        }
+};
+
+#endif /* UTILS_NORMALMASK_H_ */
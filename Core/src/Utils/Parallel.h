@@ -0,0 +1,261 @@
+/*
+ * This file is part of ElasticFusion.
+ *
+ * Copyright (C) 2015 Imperial College London
+ * 
+ * The use of the code within this file and all code within files that 
+ * make up the software that is ElasticFusion is permitted for 
+ * non-commercial purposes only.  The full terms and conditions that 
+ * apply to the code within this file are detailed within the LICENSE.txt 
+ * file and at <http://www.imperial.ac.uk/dyson-robotics-lab/downloads/elastic-fusion/elastic-fusion-license/> 
+ * unless explicitly stated.  By downloading this file you agree to 
+ * comply with these terms.
+ *
+ * If you wish to use any of this code for commercial purposes then 
+ * please email researchcontracts.engineering@imperial.ac.uk.
+ *
+ */
+
+#ifndef UTILS_PARALLEL_H_
+#define UTILS_PARALLEL_H_
+
+#include <algorithm>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class Parallel
+{
+    public:
+        /**
+         * Resolves a requested thread count
+         * @param requested number of threads, 0 means one per hardware thread
+         * @return at least 1
+         */
+        static unsigned int threadCount(const unsigned int requested)
+        {
+            if(requested > 0)
+            {
+                return requested;
+            }
+
+            return std::max(1u, std::thread::hardware_concurrency());
+        }
+
+        /**
+         * Splits [begin, end) into at most numThreads contiguous chunks and calls
+         * func(chunkBegin, chunkEnd, chunkIndex) on each, the calling thread takes the first chunk.
+         * Chunk boundaries are multiples of grain (relative to begin), so a range shorter than
+         * two grains runs serially on the calling thread. The other chunks go to a persistent worker
+         * pool, returns once every chunk is done.
+         */
+        template<typename Func>
+        static void forRange(const size_t begin, const size_t end, const unsigned int numThreads, Func func, const size_t grain = 1)
+        {
+            if(end <= begin)
+            {
+                return;
+            }
+
+            const size_t numGrains = (end - begin + grain - 1) / grain;
+            const size_t numChunks = std::min<size_t>(threadCount(numThreads), numGrains);
+
+            if(numChunks <= 1)
+            {
+                func(begin, end, 0u);
+                return;
+            }
+
+            const size_t chunkSize = ((numGrains + numChunks - 1) / numChunks) * grain;
+            const size_t usedChunks = (end - begin + chunkSize - 1) / chunkSize;
+
+            Pool & workers = pool();
+            Batch batch(usedChunks - 1);
+
+            for(size_t chunk = 1; chunk < usedChunks; chunk++)
+            {
+                const size_t chunkBegin = begin + chunk * chunkSize;
+
+                workers.submit(Task(&call<Func>, &func, chunkBegin, std::min(end, chunkBegin + chunkSize), (unsigned int)chunk, &batch));
+            }
+
+            //The queued chunks point at func and batch, so they have to finish before anything leaves this frame
+            std::exception_ptr error;
+
+            try
+            {
+                func(begin, std::min(end, begin + chunkSize), 0u);
+            }
+            catch(...)
+            {
+                error = std::current_exception();
+            }
+
+            workers.wait(batch);
+
+            if(error)
+            {
+                std::rethrow_exception(error);
+            }
+        }
+
+    private:
+        //Chunks of one forRange call still queued or running
+        class Batch
+        {
+            public:
+                Batch(const size_t pending)
+                 : pending(pending)
+                {}
+
+                size_t pending;
+        };
+
+        class Task
+        {
+            public:
+                Task(void (*run)(void *, size_t, size_t, unsigned int), void * func, const size_t begin, const size_t end, const unsigned int chunk, Batch * batch)
+                 : run(run),
+                   func(func),
+                   begin(begin),
+                   end(end),
+                   chunk(chunk),
+                   batch(batch)
+                {}
+
+                void (*run)(void *, size_t, size_t, unsigned int);
+                void * func;
+                size_t begin;
+                size_t end;
+                unsigned int chunk;
+                Batch * batch;
+        };
+
+        template<typename Func>
+        static void call(void * func, const size_t begin, const size_t end, const unsigned int chunk)
+        {
+            (*static_cast<Func *>(func))(begin, end, chunk);
+        }
+
+        /**
+         * Workers started once, one per hardware thread besides the caller, and kept for the life of the
+         * process so a forRange costs a queue push per chunk instead of a thread start. A caller waiting
+         * on its chunks runs the ones nobody has picked up yet, which keeps nested and concurrent calls
+         * from different threads (the segmentation worker and the frame loop) from waiting on each other.
+         */
+        class Pool
+        {
+            public:
+                Pool()
+                 : stopping(false)
+                {
+                    const unsigned int numWorkers = threadCount(0) - 1;
+
+                    for(unsigned int i = 0; i < numWorkers; i++)
+                    {
+                        workers.push_back(std::thread(&Pool::work, this));
+                    }
+                }
+
+                ~Pool()
+                {
+                    {
+                        std::unique_lock<std::mutex> lock(mutex);
+                        stopping = true;
+                    }
+
+                    wake.notify_all();
+
+                    for(size_t i = 0; i < workers.size(); i++)
+                    {
+                        workers.at(i).join();
+                    }
+                }
+
+                void submit(const Task & task)
+                {
+                    {
+                        std::unique_lock<std::mutex> lock(mutex);
+                        queue.push_back(task);
+                    }
+
+                    wake.notify_one();
+                }
+
+                void wait(Batch & batch)
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+
+                    while(batch.pending > 0)
+                    {
+                        size_t i = 0;
+
+                        while(i < queue.size() && queue[i].batch != &batch)
+                        {
+                            i++;
+                        }
+
+                        if(i < queue.size())
+                        {
+                            const Task task = queue[i];
+                            queue.erase(queue.begin() + i);
+                            run(task, lock);
+                        }
+                        else
+                        {
+                            done.wait(lock);
+                        }
+                    }
+                }
+
+            private:
+                void work()
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+
+                    while(true)
+                    {
+                        wake.wait(lock, [this]{ return stopping || !queue.empty(); });
+
+                        if(queue.empty())
+                        {
+                            return;
+                        }
+
+                        const Task task = queue.front();
+                        queue.erase(queue.begin());
+                        run(task, lock);
+                    }
+                }
+
+                //Runs a task with the lock released and counts it off its batch
+                void run(const Task & task, std::unique_lock<std::mutex> & lock)
+                {
+                    lock.unlock();
+                    task.run(task.func, task.begin, task.end, task.chunk);
+                    lock.lock();
+
+                    if(--task.batch->pending == 0)
+                    {
+                        done.notify_all();
+                    }
+                }
+
+                std::mutex mutex;
+                std::condition_variable wake;
+                std::condition_variable done;
+                std::vector<Task> queue;
+                std::vector<std::thread> workers;
+                bool stopping;
+        };
+
+        static Pool & pool()
+        {
+            static Pool instance;
+            return instance;
+        }
+};
+
+#endif /* UTILS_PARALLEL_H_ */
@@ -0,0 +1,105 @@
+/*
+ * This file is part of ElasticFusion.
+ *
+ * Copyright (C) 2015 Imperial College London
+ *
+ * The use of the code within this file and all code within files that
+ * make up the software that is ElasticFusion is permitted for
+ * non-commercial purposes only.  The full terms and conditions that
+ * apply to the code within this file are detailed within the LICENSE.txt
+ * file and at <http://www.imperial.ac.uk/dyson-robotics-lab/downloads/elastic-fusion/elastic-fusion-license/>
+ * unless explicitly stated.  By downloading this file you agree to
+ * comply with these terms.
+ *
+ * If you wish to use any of this code for commercial purposes then
+ * please email researchcontracts.engineering@imperial.ac.uk.
+ *
+ */
+
+#ifndef UTILS_SSEMATH_H_
+#define UTILS_SSEMATH_H_
+
+#ifdef __SSE2__
+
+#include <emmintrin.h>
+
+class SSEMath
+{
+    public:
+        static inline __m128 dot(const __m128 ax, const __m128 ay, const __m128 az,
+                                 const __m128 bx, const __m128 by, const __m128 bz)
+        {
+            return _mm_add_ps(_mm_add_ps(_mm_mul_ps(ax, bx), _mm_mul_ps(ay, by)), _mm_mul_ps(az, bz));
+        }
+
+        static inline __m128 abs(const __m128 x)
+        {
+            return _mm_andnot_ps(_mm_set1_ps(-0.0f), x);
+        }
+
+        static inline __m128 select(const __m128 mask, const __m128 a, const __m128 b)
+        {
+            return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+        }
+
+        /**
+         * Arc cosine in radians, Abramowitz & Stegun 4.4.46, absolute error below 2e-8 on [-1, 1]
+         * @param x is clamped to [-1, 1]
+         */
+        static inline __m128 acos(const __m128 x)
+        {
+            const __m128 one = _mm_set1_ps(1.0f);
+            const __m128 clamped = _mm_max_ps(_mm_set1_ps(-1.0f), _mm_min_ps(one, x));
+            const __m128 negative = _mm_cmplt_ps(clamped, _mm_setzero_ps());
+            const __m128 a = abs(clamped);
+
+            __m128 poly = _mm_set1_ps(-0.0012624911f);
+            poly = _mm_add_ps(_mm_mul_ps(poly, a), _mm_set1_ps(0.0066700901f));
+            poly = _mm_add_ps(_mm_mul_ps(poly, a), _mm_set1_ps(-0.0170881256f));
+            poly = _mm_add_ps(_mm_mul_ps(poly, a), _mm_set1_ps(0.0308918810f));
+            poly = _mm_add_ps(_mm_mul_ps(poly, a), _mm_set1_ps(-0.0501743046f));
+            poly = _mm_add_ps(_mm_mul_ps(poly, a), _mm_set1_ps(0.0889789874f));
+            poly = _mm_add_ps(_mm_mul_ps(poly, a), _mm_set1_ps(-0.2145988016f));
+            poly = _mm_add_ps(_mm_mul_ps(poly, a), _mm_set1_ps(1.5707963050f));
+
+            const __m128 result = _mm_mul_ps(_mm_sqrt_ps(_mm_sub_ps(one, a)), poly);
+
+            // acos(-x) = pi - acos(x)
+            return select(negative, _mm_sub_ps(_mm_set1_ps(3.14159265358979f), result), result);
+        }
+
+        /**
+         * Natural exponential, Cephes polynomial with a relative error of about 1e-7
+         * @param x is clamped to the range representable as a float
+         */
+        static inline __m128 exp(const __m128 x)
+        {
+            const __m128 one = _mm_set1_ps(1.0f);
+            const __m128 clamped = _mm_max_ps(_mm_set1_ps(-88.3762626647949f), _mm_min_ps(_mm_set1_ps(88.3762626647949f), x));
+
+            // Split into n * ln(2) + r with n = round(x / ln(2))
+            __m128 fx = _mm_add_ps(_mm_mul_ps(clamped, _mm_set1_ps(1.44269504088896341f)), _mm_set1_ps(0.5f));
+            __m128 floored = _mm_cvtepi32_ps(_mm_cvttps_epi32(fx));
+            floored = _mm_sub_ps(floored, _mm_and_ps(_mm_cmpgt_ps(floored, fx), one));
+
+            __m128 r = _mm_sub_ps(clamped, _mm_mul_ps(floored, _mm_set1_ps(0.693359375f)));
+            r = _mm_sub_ps(r, _mm_mul_ps(floored, _mm_set1_ps(-2.12194440e-4f)));
+
+            __m128 poly = _mm_set1_ps(1.9875691500e-4f);
+            poly = _mm_add_ps(_mm_mul_ps(poly, r), _mm_set1_ps(1.3981999507e-3f));
+            poly = _mm_add_ps(_mm_mul_ps(poly, r), _mm_set1_ps(8.3334519073e-3f));
+            poly = _mm_add_ps(_mm_mul_ps(poly, r), _mm_set1_ps(4.1665795894e-2f));
+            poly = _mm_add_ps(_mm_mul_ps(poly, r), _mm_set1_ps(1.6666665459e-1f));
+            poly = _mm_add_ps(_mm_mul_ps(poly, r), _mm_set1_ps(5.0000001201e-1f));
+            poly = _mm_add_ps(_mm_add_ps(_mm_mul_ps(poly, _mm_mul_ps(r, r)), r), one);
+
+            // Scale by 2^n by building the exponent bits directly
+            const __m128i exponent = _mm_slli_epi32(_mm_add_epi32(_mm_cvttps_epi32(floored), _mm_set1_epi32(127)), 23);
+
+            return _mm_mul_ps(poly, _mm_castsi128_ps(exponent));
+        }
+};
+
+#endif /* __SSE2__ */
+
+#endif /* UTILS_SSEMATH_H_ */
@@ -0,0 +1,97 @@
+/*
+ * This file is part of ElasticFusion.
+ *
+ * Copyright (C) 2015 Imperial College London
+ *
+ * The use of the code within this file and all code within files that
+ * make up the software that is ElasticFusion is permitted for
+ * non-commercial purposes only.  The full terms and conditions that
+ * apply to the code within this file are detailed within the LICENSE.txt
+ * file and at <http://www.imperial.ac.uk/dyson-robotics-lab/downloads/elastic-fusion/elastic-fusion-license/>
+ * unless explicitly stated.  By downloading this file you agree to
+ * comply with these terms.
+ *
+ * If you wish to use any of this code for commercial purposes then
+ * please email researchcontracts.engineering@imperial.ac.uk.
+ *
+ */
+
+#ifndef UTILS_SCRATCHARENA_H_
+#define UTILS_SCRATCHARENA_H_
+
+#include <algorithm>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+/**
+ * Bump allocator for per-frame scratch arrays of trivial types. Memory handed out stays valid until the next reset().
+ * Requests that do not fit go to separate blocks, reset() then replaces everything with one block of the combined size,
+ * so after the first frames a steady workload allocates nothing.
+ */
+class ScratchArena
+{
+    public:
+        ScratchArena()
+         : capacity(0),
+           used(0),
+           overflowBytes(0)
+        {}
+
+        void reset()
+        {
+            if(overflow.size() > 0)
+            {
+                capacity += overflowBytes;
+                block.reset(new char[capacity]);
+                overflow.clear();
+                overflowBytes = 0;
+            }
+
+            used = 0;
+        }
+
+        template<typename T>
+        T * allocate(const size_t count)
+        {
+            static_assert(std::is_trivially_destructible<T>::value, "ScratchArena never runs destructors");
+
+            const size_t bytes = std::max<size_t>(count, 1) * sizeof(T);
+            const size_t offset = (used + alignment - 1) & ~(alignment - 1);
+
+            if(offset + bytes > capacity)
+            {
+                overflow.push_back(std::unique_ptr<char[]>(new char[bytes]));
+                overflowBytes += bytes + alignment;
+                return reinterpret_cast<T *>(overflow.back().get());
+            }
+
+            used = offset + bytes;
+            return reinterpret_cast<T *>(block.get() + offset);
+        }
+
+        template<typename T>
+        T * allocate(const size_t count, const T & value)
+        {
+            T * data = allocate<T>(count);
+            std::fill(data, data + count, value);
+            return data;
+        }
+
+        size_t getCapacity() const
+        {
+            return capacity + overflowBytes;
+        }
+
+    private:
+        static const size_t alignment = 16;
+
+        std::unique_ptr<char[]> block;
+        size_t capacity;
+        size_t used;
+
+        std::vector<std::unique_ptr<char[]>> overflow;
+        size_t overflowBytes;
+};
+
+#endif /* UTILS_SCRATCHARENA_H_ */
@@ -42,6 +42,11 @@
 #include <pcl/point_types.h>
 #include <pcl/point_cloud.h>
 #include <pcl/segmentation/supervoxel_clustering.h>
+#include <Eigen/StdVector>
+#include <algorithm>
+#include <vector>
+
+#include "Utils/ScratchArena.h"
 
 #define PCL_INSTANTIATE_LCCPSegmentation(T) template class PCL_EXPORTS pcl::LCCPSegmentation<T>;
 
@@ -79,8 +84,116 @@ namespace pcl
       }
     };
 
+    /** \brief Disjoint-set forest over dense supervoxel indices, using path compression and union by rank.*/
+    class DisjointSets
+    {
+      public:
+        /** \brief Put every element 0..size-1 into its own set */
+        void
+        reset (const uint32_t size)
+        {
+          parent_.resize (size);
+          rank_.assign (size, 0);
+          for (uint32_t element = 0; element < size; ++element)
+            parent_[element] = element;
+        }
+
+        /** \brief Find the representative of the set containing element and compress the path to it */
+        uint32_t
+        find (uint32_t element)
+        {
+          uint32_t root = element;
+          while (parent_[root] != root)
+            root = parent_[root];
+
+          while (parent_[element] != root)
+          {
+            const uint32_t next = parent_[element];
+            parent_[element] = root;
+            element = next;
+          }
+          return (root);
+        }
+
+        /** \brief Merge the sets containing a and b
+         *  \return The representative of the merged set */
+        uint32_t
+        unite (const uint32_t a, const uint32_t b)
+        {
+          uint32_t root_a = find (a);
+          uint32_t root_b = find (b);
+          if (root_a == root_b)
+            return (root_a);
+
+          if (rank_[root_a] < rank_[root_b])
+            std::swap (root_a, root_b);
+          parent_[root_b] = root_a;
+          if (rank_[root_a] == rank_[root_b])
+            ++rank_[root_a];
+          return (root_a);
+        }
+
+      private:
+        std::vector<uint32_t> parent_;
+        std::vector<uint8_t> rank_;
+    };
+
     public:
 
+      /** \brief Read-only view of a contiguous range of labels inside the segmentation. It stays valid until the segmentation is reset or recomputed. */
+      class LabelSpan
+      {
+        public:
+          LabelSpan () :
+          data_ (NULL), size_ (0)
+          {
+          }
+
+          LabelSpan (const uint32_t* data_arg, const size_t size_arg) :
+          data_ (data_arg), size_ (size_arg)
+          {
+          }
+
+          explicit LabelSpan (const std::vector<uint32_t>& labels_arg) :
+          data_ (labels_arg.data ()), size_ (labels_arg.size ())
+          {
+          }
+
+          inline const uint32_t*
+          begin () const
+          {
+            return (data_);
+          }
+
+          inline const uint32_t*
+          end () const
+          {
+            return (data_ + size_);
+          }
+
+          inline size_t
+          size () const
+          {
+            return (size_);
+          }
+
+          inline bool
+          empty () const
+          {
+            return (size_ == 0);
+          }
+
+          inline uint32_t
+          operator[] (const size_t index) const
+          {
+            return (data_[index]);
+          }
+
+        private:
+          const uint32_t* data_;
+          size_t size_;
+      };
+
       // Adjacency list with nodes holding labels (uint32_t) and edges holding EdgeProperties.
       typedef typename boost::adjacency_list<boost::setS, boost::setS, boost::undirectedS, uint32_t, EdgeProperties> SupervoxelAdjacencyList;
       typedef typename boost::graph_traits<SupervoxelAdjacencyList>::vertex_iterator VertexIterator;
@@ -95,7 +208,7 @@ namespace pcl
       virtual
       ~LCCPSegmentation ();
 
-      /** \brief Reset internal memory.  */
+      /** \brief Reset internal memory. Contents are cleared but allocated capacity is kept, so one instance can be reused for every frame without reallocating.  */
       void
       reset ();
 
@@ -109,51 +222,111 @@ namespace pcl
                            const std::multimap<uint32_t, uint32_t> &label_adjacency_arg)
       {
         // Initialization
-        prepareSegmentation (supervoxel_clusters_arg, label_adjacency_arg);  // after this, sv_adjacency_list_ can be used to access adjacency list
+        prepareSegmentation (supervoxel_clusters_arg, label_adjacency_arg);  // after this, the compressed adjacency can be used to access the supervoxel graph
         supervoxels_set_ = true;
       }
       
       /** \brief Merge supervoxels using local convexity. The input parameters are generated by using the \ref SupervoxelClustering class. To retrieve the output use the \ref relabelCloud method.
-       *  \note There are three ways to retrieve the segmentation afterwards: \ref relabelCloud, \ref getSegmentSupervoxelMap and \ref getSupervoxelSegmentMap*/
+       *  \note The segmentation can be retrieved afterwards with \ref relabelCloud, \ref getSegmentToSupervoxelMap and \ref getSupervoxelToSegmentMap, or without copying with \ref getSupervoxelSegments and \ref getSegmentSupervoxels */
       void
       segment ();
 
+      /** \brief Build the hierarchical merge tree for all concavity tolerance thresholds at once. Every edge gets the smallest threshold at which it connects its supervoxels,
+       *  and the edges are merged Kruskal-style in that order. Afterwards \ref segmentAtThreshold gives the segmentation for any threshold without classifying the edges again.
+       *  \note k-convexity depends on the classification of neighboring edges and is not applied in this mode. */
+      void
+      computeMergeTree ();
+
+      /** \brief Cut the merge tree built by \ref computeMergeTree. The result is the one \ref segment gives for the same threshold (with k factor 0) and is retrieved the same way.
+       *  \param[in] concavity_tolerance_threshold_arg The concavity tolerance angle in [deg] */
+      void
+      segmentAtThreshold (const float concavity_tolerance_threshold_arg);
+
       /** \brief Relabels cloud with supervoxel labels with the computed segment labels. labeled_cloud_arg should be created using the \ref getLabeledCloud method of the \ref SupervoxelClustering class.
-       *  \param[in,out] labeled_cloud_arg Cloud to relabel  */
+       *  \param[in,out] labeled_cloud_arg Cloud to relabel. Points with a label that is not a supervoxel label get label 0.
+       *  \return The number of supervoxels */
       int
       relabelCloud (pcl::PointCloud<pcl::PointXYZL> &labeled_cloud_arg);
+
+      /** \brief Writes the segment label of every point of a cloud with supervoxel labels into a buffer, e.g. a label image.
+       *  \param[in] labeled_cloud_arg Cloud with supervoxel labels, see \ref relabelCloud
+       *  \param[out] labels_arg Buffer with room for labeled_cloud_arg.size () labels. Points with a label that is not a supervoxel label get label 0.
+       *  \return The number of supervoxels */
+      int
+      relabelCloud (const pcl::PointCloud<pcl::PointXYZL> &labeled_cloud_arg,
+                    uint32_t* labels_arg) const;
+
+      /** \brief Same as above, for float label images such as GL_LUMINANCE textures */
+      int
+      relabelCloud (const pcl::PointCloud<pcl::PointXYZL> &labeled_cloud_arg,
+                    float* labels_arg) const;
       
       /** \brief Get map<SegmentID, std::set<SuperVoxel IDs> >
        *  \param[out] segment_supervoxel_map_arg The output container. On error the map is empty. */
       inline void
       getSegmentToSupervoxelMap (std::map<uint32_t, std::set<uint32_t> >& segment_supervoxel_map_arg) const
       {
+        segment_supervoxel_map_arg = std::map<uint32_t, std::set<uint32_t> > ();
         if (grouping_data_valid_)
         {
-          segment_supervoxel_map_arg = seg_label_to_sv_list_map_;
+          for (uint32_t seg_label = 0; seg_label + 1 < segment_sv_offsets_.size (); ++seg_label)
+          {
+            const LabelSpan segment_svs = getSegmentSupervoxels (seg_label);
+            if (segment_svs.size () > 0)
+              segment_supervoxel_map_arg[seg_label].insert (segment_svs.begin (), segment_svs.end ());
+          }
         }
         else
         {
           PCL_WARN ("[pcl::LCCPSegmentation::getSegmentMap] WARNING: Call function segment first. Nothing has been done. \n");
-          segment_supervoxel_map_arg = std::map<uint32_t, std::set<uint32_t> > ();
         }
       }
       
       /** \brief Get map<Supervoxel_ID, Segment_ID>
        *  \param[out] supervoxel_segment_map_arg The output container. On error the map is empty. */
       inline void
-      getSupervoxelToSegmentMap (std::map<uint32_t, uint32_t> supervoxel_segment_map_arg) const
+      getSupervoxelToSegmentMap (std::map<uint32_t, uint32_t>& supervoxel_segment_map_arg) const
       {
+        supervoxel_segment_map_arg = std::map<uint32_t, uint32_t> ();
         if (grouping_data_valid_)
         {
-          supervoxel_segment_map_arg = sv_label_to_seg_label_map_;
+          for (size_t sv_index = 0; sv_index < sv_labels_.size (); ++sv_index)
+            supervoxel_segment_map_arg.insert (supervoxel_segment_map_arg.end (), std::make_pair (sv_labels_[sv_index], sv_segments_[sv_index]));
         }
         else
         {
           PCL_WARN ("[pcl::LCCPSegmentation::getSegmentMap] WARNING: Call function segment first. Nothing has been done. \n");
-          supervoxel_segment_map_arg = std::map<uint32_t, uint32_t> ();
         }
       }
+
+      /** \brief Get the supervoxel labels in ascending order, without copying. Entry i of \ref getSupervoxelSegments belongs to entry i of this span. */
+      inline LabelSpan
+      getSupervoxelLabels () const
+      {
+        return (LabelSpan (sv_labels_));
+      }
+
+      /** \brief Get the segment label of every supervoxel in the order of \ref getSupervoxelLabels, without copying.
+       *  \note The span is empty until \ref segment has been called. */
+      inline LabelSpan
+      getSupervoxelSegments () const
+      {
+        if (!grouping_data_valid_)
+          return (LabelSpan ());
+        return (LabelSpan (sv_segments_));
+      }
+
+      /** \brief Get the labels of the supervoxels in a segment in ascending order, without copying.
+       *  \param[in] seg_label_arg The segment label
+       *  \note The span is empty for unknown segment labels and until \ref segment has been called. */
+      inline LabelSpan
+      getSegmentSupervoxels (const uint32_t seg_label_arg) const
+      {
+        if (!grouping_data_valid_ || seg_label_arg + 1 >= segment_sv_offsets_.size ())
+          return (LabelSpan ());
+        return (LabelSpan (segment_svs_.data () + segment_sv_offsets_[seg_label_arg],
+                           segment_sv_offsets_[seg_label_arg + 1] - segment_sv_offsets_[seg_label_arg]));
+      }
       
       /** \brief Get map <SegmentID, std::set<Neighboring SegmentIDs> >
        * \param[out] segment_adjacency_map_arg map < SegmentID, std::set< Neighboring SegmentIDs> >. On error the map is empty.  */
@@ -182,20 +355,10 @@ namespace pcl
       }
       
       /** \brief Get the supervoxel adjacency graph with classified edges (boost::adjacency_list).
+       * \note The graph is stored as a compressed adjacency internally, the boost graph is built on request.
        * \param[out] adjacency_list_arg The supervoxel adjacency list with classified (convex/concave) edges. On error the list is empty.  */
-      inline void
-      getSVAdjacencyList (SupervoxelAdjacencyList& adjacency_list_arg) const
-      {
-        if (grouping_data_valid_)
-        {
-          adjacency_list_arg = sv_adjacency_list_;
-        }
-        else
-        {
-          PCL_WARN ("[pcl::LCCPSegmentation::getSVAdjacencyList] WARNING: Call function segment first. Nothing has been done. \n");
-          adjacency_list_arg = pcl::LCCPSegmentation<PointT>::SupervoxelAdjacencyList ();
-        }
-      }
+      void
+      getSVAdjacencyList (SupervoxelAdjacencyList& adjacency_list_arg) const;
       
       /** \brief Set normal threshold
        *  \param[in] concavity_tolerance_threshold_arg the concavity tolerance angle in [deg] to set */
@@ -246,12 +409,80 @@ namespace pcl
         min_segment_size_ = min_segment_size_arg;
       }
 
+      /** \brief Set the number of threads used to classify the edges in \ref calculateConvexConnections. Every thread classifies a contiguous range of edges.
+       *  \param[in] nr_threads_arg Number of threads, 0 uses one thread per hardware thread. Default is 1 (serial). */
+      inline void
+      setNumberOfThreads (const unsigned int nr_threads_arg = 0)
+      {
+        nr_threads_ = nr_threads_arg;
+      }
+
+      /** \brief Determines if the edges are classified four at a time by the SSE kernel. Results match \ref connIsConvex within float tolerance. Without SSE2 every edge goes through \ref connIsConvex.
+       *  \param[in] use_vectorized_convexity_arg Use the SSE kernel (default) or call \ref connIsConvex for every edge */
+      inline void
+      setVectorizedConvexity (const bool use_vectorized_convexity_arg)
+      {
+        use_vectorized_convexity_ = use_vectorized_convexity_arg;
+      }
+
     protected:
 
-      /** \brief Segments smaller than \ref min_segment_size_ are merged to the label of largest neighbor */
+      /** \brief Segments smaller than \ref min_segment_size_ are merged to the label of largest neighbor
+       *  \note Works on the contracted segment graph. Small segments are merged smallest first and the neighbor sets are updated with every merge. */
       void
       mergeSmallSegments ();
 
+      /** \brief Fill \ref sv_label_to_seg_label_ from the final grouping */
+      void
+      buildRelabelTable ();
+
+      /** \brief Segment label of a supervoxel label, 0 if the label is unknown */
+      inline uint32_t
+      segLabel (const uint32_t sv_label_arg) const
+      {
+        return ((sv_label_arg < sv_label_to_seg_label_.size ()) ? sv_label_to_seg_label_[sv_label_arg] : 0u);
+      }
+
+      /** \brief Look up the segment label of every point in \ref sv_label_to_seg_label_, split over \ref nr_threads_ threads
+       *  \param[in] labeled_cloud_arg Cloud with supervoxel labels
+       *  \param[out] labels_arg Output buffer with room for labeled_cloud_arg.size () labels */
+      template <typename LabelT> void
+      relabelToBuffer (const pcl::PointCloud<pcl::PointXYZL> &labeled_cloud_arg,
+                       LabelT* labels_arg) const;
+
+      /** \brief Fill \ref segment_sv_offsets_ and \ref segment_svs_ from \ref sv_segments_
+       *  \param[in] max_seg_label_arg Largest segment label in use */
+      void
+      buildSegmentMembership (const uint32_t max_seg_label_arg);
+
+      /** \brief Dense index of a supervoxel label
+       *  \return The index or \ref INVALID_INDEX if the label is unknown */
+      inline uint32_t
+      svIndex (const uint32_t sv_label_arg) const
+      {
+        if (sv_label_arg < sv_label_to_index_.size ())
+          return (sv_label_to_index_[sv_label_arg]);
+        return (INVALID_INDEX);
+      }
+
+      /** \brief Remove value from a sorted vector if present */
+      static inline void
+      eraseSorted (std::vector<uint32_t>& values_arg, const uint32_t value_arg)
+      {
+        std::vector<uint32_t>::iterator value_itr = std::lower_bound (values_arg.begin (), values_arg.end (), value_arg);
+        if (value_itr != values_arg.end () && *value_itr == value_arg)
+          values_arg.erase (value_itr);
+      }
+
+      /** \brief Insert value into a sorted vector unless present */
+      static inline void
+      insertSorted (std::vector<uint32_t>& values_arg, const uint32_t value_arg)
+      {
+        std::vector<uint32_t>::iterator value_itr = std::lower_bound (values_arg.begin (), values_arg.end (), value_arg);
+        if (value_itr == values_arg.end () || *value_itr != value_arg)
+          values_arg.insert (value_itr, value_arg);
+      }
+
       /** \brief Compute the adjacency of the segments */
       void
       computeSegmentAdjacency ();
@@ -264,28 +495,29 @@ namespace pcl
                            const std::multimap<uint32_t, uint32_t> &label_adjacency_arg);
 
 
-      /** Perform depth search on the graph and recursively group all supervoxels with convex connections
-       *  \note The vertices in the supervoxel adjacency list are the supervoxel centroids */
+      /** Group all supervoxels connected by valid (convex) edges. The connected components are found with a disjoint-set forest over the valid edges.
+       *  \note Segment labels are handed out in the order of the dense vertex index (ascending supervoxel label) */
       void
       doGrouping ();
-      
-      /** \brief Assigns neighbors of the query point to the same group as the query point. Recursive part of \ref doGrouping. Grouping is done by a depth-search of nodes in the adjacency-graph.
-       *  \param[in] queryPointID ID of point whose neighbors will be considered for grouping
-       *  \param[in] group_label ID of the group/segment the queried point belongs to  */
-      void
-      recursiveSegmentGrowing (const VertexID  &queryPointID,
-                               const unsigned int group_label);
 
-      /** \brief Calculates convexity of edges and saves this to the adjacency graph.
-       *  \param[in,out] adjacency_list_arg The supervoxel adjacency list*/
+      /** \brief Calculates convexity of all edges and saves this to \ref edge_properties_.
+       *  \note Edges are independent, with \ref nr_threads_ != 1 they are split into contiguous ranges classified in parallel. */
       void
-      calculateConvexConnections (SupervoxelAdjacencyList& adjacency_list_arg);
+      calculateConvexConnections ();
 
       /** \brief Connections are only convex if this is true for at least k_arg common neighbors of the two patches. Call \ref setKFactor before \ref segment to use this.
+       *  \note Common neighbors are found by intersecting sorted per-vertex lists of convex neighbors. Edges are counted in parallel with \ref nr_threads_ threads and invalidated once all counts are known.
        *  \param[in] k_arg Factor used for extended convexity check */
       void
       applyKconvexity (const unsigned int k_arg);
 
+      /** \brief Classifies the edges [begin_arg, end_arg) eight at a time when built with AVX and four at a time with SSE2 from the structure-of-arrays buffers, evaluating the same criteria as \ref connIsConvex.
+       *  \param[in] begin_arg First edge index
+       *  \param[in] end_arg One past the last edge index */
+      void
+      classifyEdgesVectorized (const size_t begin_arg,
+                               const size_t end_arg);
+
       /** \brief Returns true if the connection between source and target is convex.
        *  \param[in] source_label_arg Label of one supervoxel connected to the edge that should be checked
        *  \param[in] target_label_arg Label of the other supervoxel connected to the edge that should be checked
@@ -294,19 +526,22 @@ namespace pcl
       bool
       connIsConvex (const uint32_t source_label_arg,
                     const uint32_t target_label_arg,
-                    float &normal_angle);
+                    float &normal_angle) const;
 
       ///  *** Parameters *** ///
 
       /** \brief Normal Threshold in degrees [0,180] used for merging */
       float concavity_tolerance_threshold_;
 
-      /** \brief Marks if valid grouping data (\ref sv_adjacency_list_, \ref sv_label_to_seg_label_map_, \ref processed_) is avaiable */
+      /** \brief Marks if valid grouping data (\ref edge_properties_, \ref sv_segments_, \ref segment_sv_offsets_, \ref segment_svs_) is avaiable */
       bool grouping_data_valid_;
       
       /** \brief Marks if supervoxels have been set by calling \ref setInputSupervoxels */
       bool supervoxels_set_;
 
+      /** \brief Marks if \ref merge_tree_parents_ belongs to the current supervoxels */
+      bool merge_tree_valid_;
+
       /** \brief Determines if the smoothness check is used during segmentation*/
       bool use_smoothness_check_;
 
@@ -328,26 +563,85 @@ namespace pcl
       /** \brief Minimum segment size */
       uint32_t min_segment_size_;
 
-      /** \brief Stores which supervoxel labels were already visited during recursive grouping.    
-       *  \note processed_[sv_Label] = false (default)/true (already processed) */
-      std::map<uint32_t, bool> processed_;
+      /** \brief Number of threads used for the edge classification, 0 means one per hardware thread */
+      unsigned int nr_threads_;
+
+      /** \brief Determines if the SSE kernel is used for the edge classification */
+      bool use_vectorized_convexity_;
+
+      /** \brief Supervoxel labels in the order of their dense vertex index. The adjacency below refers to supervoxels by this index. */
+      std::vector<uint32_t> sv_labels_;
+
+      /** \brief Compressed adjacency: the neighbors of vertex i are stored in [adjacency_offsets_[i], adjacency_offsets_[i+1]) */
+      std::vector<uint32_t> adjacency_offsets_;
+
+      /** \brief Dense index of the neighboring vertex for every entry of the compressed adjacency. Sorted within each vertex. */
+      std::vector<uint32_t> adjacency_neighbors_;
+
+      /** \brief Index into \ref edge_properties_ for every entry of the compressed adjacency */
+      std::vector<uint32_t> adjacency_edges_;
+
+      /** \brief Dense vertex indices (source, target) of every undirected edge with source < target */
+      std::vector<std::pair<uint32_t, uint32_t> > edge_vertices_;
+
+      /** \brief Classification of every undirected edge, indexed like \ref edge_vertices_ */
+      std::vector<EdgeProperties> edge_properties_;
+
+      /** \brief Smallest concavity tolerance threshold above which every edge is valid: negative for convex edges, the normal difference for concave ones and infinity for edges that are never valid */
+      std::vector<float> edge_merge_angles_;
+
+      /** \brief Kruskal merge tree. Nodes 0..nr_vertices-1 are the supervoxels, node nr_vertices+i is the i-th merge. Merge nodes are created in ascending angle order, so every parent has a larger index than its children. Roots point to themselves. */
+      std::vector<uint32_t> merge_tree_parents_;
+
+      /** \brief Merge angle of merge node nr_vertices+i, ascending */
+      std::vector<float> merge_tree_angles_;
 
-      /** \brief Adjacency graph with the supervoxel labels as nodes and edges between adjacent supervoxels */
-      SupervoxelAdjacencyList sv_adjacency_list_;
+      /** \brief Supervoxel centroids as x, y and z arrays indexed by the dense vertex index */
+      std::vector<float, Eigen::aligned_allocator<float> > sv_centroids_[3];
 
-      /** \brief map from the supervoxel labels to the supervoxel objects  */
-      std::map<uint32_t, typename pcl::Supervoxel<PointT>::Ptr> sv_label_to_supervoxel_map_;
+      /** \brief Normalized supervoxel normals as x, y and z arrays indexed by the dense vertex index */
+      std::vector<float, Eigen::aligned_allocator<float> > sv_normals_[3];
 
-      /** \brief Storing relation between original SuperVoxel Labels and new segmantion labels. 
-       *  \note sv_label_to_seg_label_map_[old_labelID] = new_labelID */
-      std::map<uint32_t, uint32_t> sv_label_to_seg_label_map_;
+      /** \brief The supervoxel objects, indexed by the dense vertex index */
+      std::vector<typename pcl::Supervoxel<PointT>::Ptr> sv_supervoxels_;
 
-      /** \brief map <Segment Label, std::set <SuperVoxel Labels> > */
-      std::map<uint32_t, std::set<uint32_t> > seg_label_to_sv_list_map_;
+      /** \brief Marks supervoxel labels without a dense index in \ref sv_label_to_index_ */
+      static const uint32_t INVALID_INDEX = 0xFFFFFFFF;
+
+      /** \brief Dense vertex index of every supervoxel label, \ref INVALID_INDEX for labels that are not in the input. Supervoxel labels are small consecutive integers, so this is a flat table. */
+      std::vector<uint32_t> sv_label_to_index_;
+
+      /** \brief Segment label of every supervoxel, indexed by the dense vertex index */
+      std::vector<uint32_t> sv_segments_;
+
+      /** \brief The supervoxels of segment s are stored in [segment_sv_offsets_[s], segment_sv_offsets_[s+1]) of \ref segment_svs_ */
+      std::vector<uint32_t> segment_sv_offsets_;
+
+      /** \brief Supervoxel labels grouped by segment, ascending within each segment */
+      std::vector<uint32_t> segment_svs_;
+
+      /** \brief Segment label of every supervoxel label, 0 for labels that are not in the input. Used by \ref relabelCloud. */
+      std::vector<uint32_t> sv_label_to_seg_label_;
 
       /** \brief map < SegmentID, std::set< Neighboring segment labels> > */
       std::map<uint32_t, std::set<uint32_t> > seg_label_to_neighbor_set_map_;
 
+      ///  *** Scratch storage, kept between frames *** ///
+
+      /** \brief Per-frame scratch arrays, rewound by \ref reset and at the start of every segmentation */
+      ScratchArena scratch_;
+
+      /** \brief Disjoint sets used by \ref doGrouping and \ref computeMergeTree */
+      DisjointSets sv_sets_;
+
+      /** \brief Sorted neighbor lists of the segments used by \ref mergeSmallSegments */
+      std::vector<std::vector<uint32_t> > segment_neighbors_;
+
+      typedef std::pair<uint32_t, uint32_t> SizeLabelPair;
+
+      /** \brief Min-heap of (size, label) of the small segments used by \ref mergeSmallSegments */
+      std::vector<SizeLabelPair> small_segments_;
+
   };
 }
 
@@ -39,6 +39,13 @@
 #define PCL_SEGMENTATION_IMPL_LCCP_SEGMENTATION_HPP_
 
 #include "lccp.h"
+#include "Utils/Parallel.h"
+#include "Utils/SSEMath.h"
+#include "Utils/AVXMath.h"
+
+#include <algorithm>
+#include <functional>
+#include <limits>
 
 
 //////////////////////////////////////////////////////////
@@ -49,18 +56,23 @@
 
 
 
+template <typename PointT> const uint32_t pcl::LCCPSegmentation<PointT>::INVALID_INDEX;
+
 template <typename PointT>
 pcl::LCCPSegmentation<PointT>::LCCPSegmentation () :
   concavity_tolerance_threshold_ (10),
   grouping_data_valid_ (false),
   supervoxels_set_ (false),
+  merge_tree_valid_ (false),
   use_smoothness_check_ (false),
   smoothness_threshold_ (0.1),
   use_sanity_check_ (false),  
   seed_resolution_ (0),
   voxel_resolution_ (0),
   k_factor_ (0),
-  min_segment_size_ (0)
+  min_segment_size_ (0),
+  nr_threads_ (1),
+  use_vectorized_convexity_ (true)
 {
 }
 
@@ -72,14 +84,31 @@ pcl::LCCPSegmentation<PointT>::~LCCPSegmentation ()
 template <typename PointT> void
 pcl::LCCPSegmentation<PointT>::reset ()
 {
-  sv_adjacency_list_.clear ();
-  processed_.clear ();
-  sv_label_to_supervoxel_map_.clear ();
-  sv_label_to_seg_label_map_.clear ();
-  seg_label_to_sv_list_map_.clear ();
+  sv_labels_.clear ();
+  adjacency_offsets_.clear ();
+  adjacency_neighbors_.clear ();
+  adjacency_edges_.clear ();
+  edge_vertices_.clear ();
+  edge_properties_.clear ();
+  edge_merge_angles_.clear ();
+  merge_tree_parents_.clear ();
+  merge_tree_angles_.clear ();
+  for (int dim = 0; dim < 3; ++dim)
+  {
+    sv_centroids_[dim].clear ();
+    sv_normals_[dim].clear ();
+  }
+  sv_supervoxels_.clear ();
+  sv_label_to_index_.clear ();
+  sv_segments_.clear ();
+  segment_sv_offsets_.clear ();
+  segment_svs_.clear ();
+  sv_label_to_seg_label_.clear ();
   seg_label_to_neighbor_set_map_.clear ();
   grouping_data_valid_ = false;
   supervoxels_set_ = false;
+  merge_tree_valid_ = false;
+  scratch_.reset ();
 }
 
 template <typename PointT> void
@@ -87,9 +116,11 @@ pcl::LCCPSegmentation<PointT>::segment ()
 {
   if (supervoxels_set_)
   {
+    scratch_.reset ();
+
     // Calculate for every Edge if the connection is convex or invalid
     // This effectively performs the segmentation.
-    calculateConvexConnections (sv_adjacency_list_);
+    calculateConvexConnections ();
 
     // Correct edge relations using extended convexity definition if k>0
     applyKconvexity (k_factor_);
@@ -101,11 +132,137 @@ pcl::LCCPSegmentation<PointT>::segment ()
     
     // merge small segments
     mergeSmallSegments ();
+
+    buildRelabelTable ();
   }
   else
     PCL_WARN ("[pcl::LCCPSegmentation::segment] WARNING: Call function setInputSupervoxels first. Nothing has been done. \n");
 }
 
+template <typename PointT> void
+pcl::LCCPSegmentation<PointT>::computeMergeTree ()
+{
+  if (!supervoxels_set_)
+  {
+    PCL_WARN ("[pcl::LCCPSegmentation::computeMergeTree] WARNING: Call function setInputSupervoxels first. Nothing has been done. \n");
+    return;
+  }
+  if (k_factor_ > 0)
+    PCL_WARN ("[pcl::LCCPSegmentation::computeMergeTree] WARNING: k-convexity is not applied in hierarchical mode. \n");
+
+  // The threshold only enters the classification as "convex || normal_difference < threshold". Classifying at threshold 0 gives the convex edges,
+  // classifying without a threshold gives the edges that pass the smoothness and sanity checks. The rest of those merge once the threshold exceeds their normal difference.
+  const float concavity_tolerance_threshold = concavity_tolerance_threshold_;
+  edge_merge_angles_.assign (edge_vertices_.size (), std::numeric_limits<float>::infinity ());
+
+  concavity_tolerance_threshold_ = std::numeric_limits<float>::infinity ();
+  calculateConvexConnections ();
+  for (size_t edge_index = 0; edge_index < edge_vertices_.size (); ++edge_index)
+  {
+    if (edge_properties_[edge_index].is_convex)
+      edge_merge_angles_[edge_index] = edge_properties_[edge_index].normal_difference;
+  }
+
+  concavity_tolerance_threshold_ = 0;
+  calculateConvexConnections ();
+  for (size_t edge_index = 0; edge_index < edge_vertices_.size (); ++edge_index)
+  {
+    if (edge_properties_[edge_index].is_convex)
+      edge_merge_angles_[edge_index] = -1;
+  }
+  concavity_tolerance_threshold_ = concavity_tolerance_threshold;
+
+  // Kruskal: merge the edges in ascending angle order, every union adds a merge node on top of the two subtrees
+  scratch_.reset ();
+  uint32_t* edge_order = scratch_.allocate<uint32_t> (edge_vertices_.size ());
+  size_t nr_ordered_edges = 0;
+  for (uint32_t edge_index = 0; edge_index < edge_vertices_.size (); ++edge_index)
+  {
+    if (edge_merge_angles_[edge_index] != std::numeric_limits<float>::infinity ())
+      edge_order[nr_ordered_edges++] = edge_index;
+  }
+  std::sort (edge_order, edge_order + nr_ordered_edges, [this] (const uint32_t a, const uint32_t b)
+  {
+    return (edge_merge_angles_[a] < edge_merge_angles_[b] || (edge_merge_angles_[a] == edge_merge_angles_[b] && a < b));
+  });
+
+  const uint32_t nr_vertices = static_cast<uint32_t> (sv_labels_.size ());
+  merge_tree_parents_.resize (nr_vertices);
+  for (uint32_t sv_index = 0; sv_index < nr_vertices; ++sv_index)
+    merge_tree_parents_[sv_index] = sv_index;
+  merge_tree_angles_.clear ();
+
+  sv_sets_.reset (nr_vertices);
+  uint32_t* set_tree_node = scratch_.allocate<uint32_t> (nr_vertices);  // Topmost tree node of every set, stored at the set representative
+  std::copy (merge_tree_parents_.begin (), merge_tree_parents_.end (), set_tree_node);
+  for (size_t order_index = 0; order_index < nr_ordered_edges; ++order_index)
+  {
+    const uint32_t edge_index = edge_order[order_index];
+    const uint32_t source_root = sv_sets_.find (edge_vertices_[edge_index].first);
+    const uint32_t target_root = sv_sets_.find (edge_vertices_[edge_index].second);
+    if (source_root == target_root)
+      continue;
+
+    const uint32_t merge_node = static_cast<uint32_t> (merge_tree_parents_.size ());
+    merge_tree_parents_.push_back (merge_node);
+    merge_tree_angles_.push_back (edge_merge_angles_[edge_index]);
+    merge_tree_parents_[set_tree_node[source_root]] = merge_node;
+    merge_tree_parents_[set_tree_node[target_root]] = merge_node;
+    set_tree_node[sv_sets_.unite (source_root, target_root)] = merge_node;
+  }
+
+  merge_tree_valid_ = true;
+}
+
+template <typename PointT> void
+pcl::LCCPSegmentation<PointT>::segmentAtThreshold (const float concavity_tolerance_threshold_arg)
+{
+  if (!merge_tree_valid_)
+  {
+    PCL_WARN ("[pcl::LCCPSegmentation::segmentAtThreshold] WARNING: Call function computeMergeTree first. Nothing has been done. \n");
+    return;
+  }
+  concavity_tolerance_threshold_ = concavity_tolerance_threshold_arg;
+  scratch_.reset ();
+
+  // Edges and merges are valid below the threshold. For angles below 0 nothing will be merged.
+  const bool merge_anything = concavity_tolerance_threshold_ >= 0;
+  for (size_t edge_index = 0; edge_index < edge_vertices_.size (); ++edge_index)
+  {
+    edge_properties_[edge_index].is_convex = merge_anything && edge_merge_angles_[edge_index] < concavity_tolerance_threshold_;
+    edge_properties_[edge_index].is_valid = edge_properties_[edge_index].is_convex;
+  }
+
+  const uint32_t nr_vertices = static_cast<uint32_t> (sv_labels_.size ());
+  const uint32_t nr_merges = merge_anything ? static_cast<uint32_t> (std::lower_bound (merge_tree_angles_.begin (), merge_tree_angles_.end (), concavity_tolerance_threshold_) - merge_tree_angles_.begin ()) : 0;
+
+  // Topmost node below the threshold for every node. Parents have larger indices, so walking down from the last valid merge resolves every parent before its children.
+  uint32_t* cut_root = scratch_.allocate<uint32_t> (nr_vertices + nr_merges);
+  for (uint32_t node = nr_vertices + nr_merges; node-- > 0;)
+  {
+    const uint32_t parent = merge_tree_parents_[node];
+    cut_root[node] = (parent != node && parent < nr_vertices + nr_merges) ? cut_root[parent] : node;
+  }
+
+  // Segment labels are handed out in vertex order, like in doGrouping
+  uint32_t* root_segment_label = scratch_.allocate<uint32_t> (nr_vertices + nr_merges, 0);
+  uint32_t segment_label = 1;  // This starts at 1, because 0 is reserved for errors
+  for (uint32_t sv_index = 0; sv_index < nr_vertices; ++sv_index)
+  {
+    const uint32_t root = cut_root[sv_index];
+    if (root_segment_label[root] == 0)
+      root_segment_label[root] = segment_label++;
+    sv_segments_[sv_index] = root_segment_label[root];
+  }
+  buildSegmentMembership (segment_label - 1);
+  seg_label_to_neighbor_set_map_.clear ();
+
+  grouping_data_valid_ = true;
+
+  mergeSmallSegments ();
+
+  buildRelabelTable ();
+}
 
 template <typename PointT> int
 pcl::LCCPSegmentation<PointT>::relabelCloud (pcl::PointCloud<pcl::PointXYZL> &labeled_cloud_arg)
@@ -113,17 +270,62 @@ pcl::LCCPSegmentation<PointT>::relabelCloud (pcl::PointCloud<pcl::PointXYZL> &la
   if (grouping_data_valid_)
   {
     // Relabel all Points in cloud with new labels
-    typename pcl::PointCloud<pcl::PointXYZL>::iterator voxel_itr = labeled_cloud_arg.begin ();
-    for (; voxel_itr != labeled_cloud_arg.end (); ++voxel_itr)
+    Parallel::forRange (0, labeled_cloud_arg.size (), nr_threads_, [&] (const size_t begin, const size_t end, const unsigned int)
     {
-      voxel_itr->label = sv_label_to_seg_label_map_[voxel_itr->label];
-    }
+      for (size_t point_index = begin; point_index < end; ++point_index)
+        labeled_cloud_arg[point_index].label = segLabel (labeled_cloud_arg[point_index].label);
+    }, 4096);
   }
   else
   {
     PCL_WARN ("[pcl::LCCPSegmentation::relabelCloud] WARNING: Call function segment first. Nothing has been done. \n");
   }
-  return sv_label_to_seg_label_map_.size();
+  return static_cast<int> (sv_labels_.size ());
+}
+
+template <typename PointT> int
+pcl::LCCPSegmentation<PointT>::relabelCloud (const pcl::PointCloud<pcl::PointXYZL> &labeled_cloud_arg,
+                                             uint32_t* labels_arg) const
+{
+  if (grouping_data_valid_)
+    relabelToBuffer (labeled_cloud_arg, labels_arg);
+  else
+    PCL_WARN ("[pcl::LCCPSegmentation::relabelCloud] WARNING: Call function segment first. Nothing has been done. \n");
+  return static_cast<int> (sv_labels_.size ());
+}
+
+template <typename PointT> int
+pcl::LCCPSegmentation<PointT>::relabelCloud (const pcl::PointCloud<pcl::PointXYZL> &labeled_cloud_arg,
+                                             float* labels_arg) const
+{
+  if (grouping_data_valid_)
+    relabelToBuffer (labeled_cloud_arg, labels_arg);
+  else
+    PCL_WARN ("[pcl::LCCPSegmentation::relabelCloud] WARNING: Call function segment first. Nothing has been done. \n");
+  return static_cast<int> (sv_labels_.size ());
+}
+
+template <typename PointT> void
+pcl::LCCPSegmentation<PointT>::getSVAdjacencyList (SupervoxelAdjacencyList& adjacency_list_arg) const
+{
+  adjacency_list_arg = pcl::LCCPSegmentation<PointT>::SupervoxelAdjacencyList ();
+  if (grouping_data_valid_)
+  {
+    std::vector<VertexID> vertex_ids (sv_labels_.size ());
+    for (size_t sv_index = 0; sv_index < sv_labels_.size (); ++sv_index)
+    {
+      vertex_ids[sv_index] = boost::add_vertex (sv_labels_[sv_index], adjacency_list_arg);
+    }
+
+    for (size_t edge_index = 0; edge_index < edge_vertices_.size (); ++edge_index)
+    {
+      boost::add_edge (vertex_ids[edge_vertices_[edge_index].first], vertex_ids[edge_vertices_[edge_index].second], edge_properties_[edge_index], adjacency_list_arg);
+    }
+  }
+  else
+  {
+    PCL_WARN ("[pcl::LCCPSegmentation::getSVAdjacencyList] WARNING: Call function segment first. Nothing has been done. \n");
+  }
 }
 
 
@@ -139,25 +341,18 @@ pcl::LCCPSegmentation<PointT>::computeSegmentAdjacency ()
 {  
   seg_label_to_neighbor_set_map_.clear ();
 
-  //The vertices in the supervoxel adjacency list are the supervoxel centroids
-  std::pair<VertexIterator, VertexIterator> vertex_iterator_range;
-  vertex_iterator_range = boost::vertices (sv_adjacency_list_);
-
   uint32_t current_segLabel;
   uint32_t neigh_segLabel;
 
   // For every Supervoxel..
-  for (VertexIterator sv_itr = vertex_iterator_range.first; sv_itr != vertex_iterator_range.second; ++sv_itr)  // For all supervoxels
+  for (uint32_t sv_index = 0; sv_index < sv_labels_.size (); ++sv_index)  // For all supervoxels
   {
-    const uint32_t& sv_label = sv_adjacency_list_[*sv_itr];
-    current_segLabel = sv_label_to_seg_label_map_[sv_label];
+    current_segLabel = sv_segments_[sv_index];
 
     // ..look at all neighbors and insert their labels into the neighbor set
-    std::pair<AdjacencyIterator, AdjacencyIterator> neighbors = boost::adjacent_vertices (*sv_itr, sv_adjacency_list_);
-    for (AdjacencyIterator itr_neighbor = neighbors.first; itr_neighbor != neighbors.second; ++itr_neighbor)
+    for (uint32_t neighbor_itr = adjacency_offsets_[sv_index]; neighbor_itr < adjacency_offsets_[sv_index + 1]; ++neighbor_itr)
     {
-      const uint32_t& neigh_label = sv_adjacency_list_[*itr_neighbor];
-      neigh_segLabel = sv_label_to_seg_label_map_[neigh_label];
+      neigh_segLabel = sv_segments_[adjacency_neighbors_[neighbor_itr]];
 
       if (current_segLabel != neigh_segLabel)
       {
@@ -173,84 +368,114 @@ pcl::LCCPSegmentation<PointT>::mergeSmallSegments ()
   if (min_segment_size_ == 0)
     return;
 
-  computeSegmentAdjacency ();
+  // Contract the supervoxel graph to a segment graph. Segment labels are dense (1..nr_segments) after doGrouping.
+  const uint32_t nr_vertices = static_cast<uint32_t> (sv_labels_.size ());
+  const uint32_t nr_segments = static_cast<uint32_t> (segment_sv_offsets_.size ()) - 2;
 
-  std::set<uint32_t> filteredSegLabels;
+  uint32_t* segment_size = scratch_.allocate<uint32_t> (nr_segments + 1, 0);
+  for (uint32_t segment = 1; segment <= nr_segments; ++segment)
+    segment_size[segment] = segment_sv_offsets_[segment + 1] - segment_sv_offsets_[segment];
 
-  uint32_t largest_neigh_size = 0;
-  uint32_t largest_neigh_seg_label = 0;
-  uint32_t current_seg_label;
+  // Sorted neighbor lists. The lists are cleared rather than destroyed, so they keep their capacity from one frame to the next.
+  if (segment_neighbors_.size () < nr_segments + 1)
+    segment_neighbors_.resize (nr_segments + 1);
+  for (uint32_t segment = 0; segment <= nr_segments; ++segment)
+    segment_neighbors_[segment].clear ();
+  for (size_t edge_index = 0; edge_index < edge_vertices_.size (); ++edge_index)
+  {
+    const uint32_t source_segment = sv_segments_[edge_vertices_[edge_index].first];
+    const uint32_t target_segment = sv_segments_[edge_vertices_[edge_index].second];
+    if (source_segment != target_segment)
+    {
+      segment_neighbors_[source_segment].push_back (target_segment);
+      segment_neighbors_[target_segment].push_back (source_segment);
+    }
+  }
+  for (uint32_t segment = 1; segment <= nr_segments; ++segment)
+  {
+    std::vector<uint32_t>& neighbors = segment_neighbors_[segment];
+    std::sort (neighbors.begin (), neighbors.end ());
+    neighbors.erase (std::unique (neighbors.begin (), neighbors.end ()), neighbors.end ());
+  }
 
-  std::pair<VertexIterator, VertexIterator> vertex_iterator_range;
-  vertex_iterator_range = boost::vertices (sv_adjacency_list_);
+  // Small segments in a min-heap ordered by (size, label). Entries are not updated in place, stale ones are skipped when popped.
+  const std::greater<SizeLabelPair> heap_order;
+  small_segments_.clear ();
+  for (uint32_t segment = 1; segment <= nr_segments; ++segment)
+  {
+    if (segment_size[segment] > 0 && segment_size[segment] <= min_segment_size_)
+      small_segments_.push_back (std::make_pair (segment_size[segment], segment));
+  }
+  std::make_heap (small_segments_.begin (), small_segments_.end (), heap_order);
 
-  bool continue_filtering = true;
+  // merged_into[segment] is the segment it was merged into, or the segment itself while it exists
+  uint32_t* merged_into = scratch_.allocate<uint32_t> (nr_segments + 1);
+  for (uint32_t segment = 0; segment <= nr_segments; ++segment)
+    merged_into[segment] = segment;
 
-  while (continue_filtering)
+  while (!small_segments_.empty ())
   {
-    continue_filtering = false;
-    unsigned int nr_filtered = 0;
-
-    // Iterate through all supervoxels, check if they are in a "small" segment -> change label to largest neighborID
-    for (VertexIterator sv_itr = vertex_iterator_range.first; sv_itr != vertex_iterator_range.second; ++sv_itr)  // For all supervoxels
+    std::pop_heap (small_segments_.begin (), small_segments_.end (), heap_order);
+    const uint32_t current_size = small_segments_.back ().first;
+    const uint32_t current_seg_label = small_segments_.back ().second;
+    small_segments_.pop_back ();
+
+    if (merged_into[current_seg_label] != current_seg_label || segment_size[current_seg_label] != current_size)
+      continue;  // Stale entry
+
+    std::vector<uint32_t>& current_neighbors = segment_neighbors_[current_seg_label];
+    if (current_neighbors.empty ())
+      continue;
+
+    // Find largest neighbor, ties go to the higher label. Since the smallest segment is processed first, it is at least as large as the current one.
+    uint32_t largest_neigh_seg_label = current_seg_label;
+    uint32_t largest_neigh_size = 0;
+    for (size_t neighbor_itr = 0; neighbor_itr < current_neighbors.size (); ++neighbor_itr)
     {
-      const uint32_t& sv_label = sv_adjacency_list_[*sv_itr];
-      current_seg_label = sv_label_to_seg_label_map_[sv_label];
-      largest_neigh_seg_label = current_seg_label;
-      largest_neigh_size = seg_label_to_sv_list_map_[current_seg_label].size ();
-
-      const uint32_t& nr_neighbors = seg_label_to_neighbor_set_map_[current_seg_label].size ();
-      if (nr_neighbors == 0)
-        continue;
-
-      if (seg_label_to_sv_list_map_[current_seg_label].size () <= min_segment_size_)
+      if (segment_size[current_neighbors[neighbor_itr]] >= largest_neigh_size)
       {
-        continue_filtering = true;
-        nr_filtered++;
+        largest_neigh_seg_label = current_neighbors[neighbor_itr];
+        largest_neigh_size = segment_size[current_neighbors[neighbor_itr]];
+      }
+    }
 
-        // Find largest neighbor
-        std::set<uint32_t>::const_iterator neighbors_itr = seg_label_to_neighbor_set_map_[current_seg_label].begin ();
-        for (; neighbors_itr != seg_label_to_neighbor_set_map_[current_seg_label].end (); ++neighbors_itr)
-        {
-          if (seg_label_to_sv_list_map_[*neighbors_itr].size () >= largest_neigh_size)
-          {
-            largest_neigh_seg_label = *neighbors_itr;
-            largest_neigh_size = seg_label_to_sv_list_map_[*neighbors_itr].size ();
-          }
-        }
+    // Add to largest neighbor and move the adjacency of the current segment over to it
+    std::vector<uint32_t>& largest_neighbors = segment_neighbors_[largest_neigh_seg_label];
+    eraseSorted (largest_neighbors, current_seg_label);
+    for (size_t neighbor_itr = 0; neighbor_itr < current_neighbors.size (); ++neighbor_itr)
+    {
+      const uint32_t neighbor = current_neighbors[neighbor_itr];
+      if (neighbor == largest_neigh_seg_label)
+        continue;
 
-        // Add to largest neighbor
-        if (largest_neigh_seg_label != current_seg_label)
-        {
-          if (filteredSegLabels.count (largest_neigh_seg_label) > 0)
-            continue;  // If neighbor was already assigned to someone else
-
-          sv_label_to_seg_label_map_[sv_label] = largest_neigh_seg_label;
-          filteredSegLabels.insert (current_seg_label);
-
-          // Assign supervoxel labels of filtered segment to new owner
-          std::set<uint32_t>::iterator sv_ID_itr = seg_label_to_sv_list_map_[current_seg_label].begin ();
-          sv_ID_itr = seg_label_to_sv_list_map_[current_seg_label].begin ();
-          for (; sv_ID_itr != seg_label_to_sv_list_map_[current_seg_label].end (); ++sv_ID_itr)
-          {
-            seg_label_to_sv_list_map_[largest_neigh_seg_label].insert (*sv_ID_itr);
-          }
-        }
-      }
+      eraseSorted (segment_neighbors_[neighbor], current_seg_label);
+      insertSorted (segment_neighbors_[neighbor], largest_neigh_seg_label);
+      insertSorted (largest_neighbors, neighbor);
     }
+    current_neighbors.clear ();
 
-    // Erase filtered Segments from segment map
-    std::set<uint32_t>::iterator filtered_ID_itr = filteredSegLabels.begin ();
-    for (; filtered_ID_itr != filteredSegLabels.end (); ++filtered_ID_itr)
+    segment_size[largest_neigh_seg_label] += segment_size[current_seg_label];
+    segment_size[current_seg_label] = 0;
+    merged_into[current_seg_label] = largest_neigh_seg_label;
+
+    if (segment_size[largest_neigh_seg_label] <= min_segment_size_)
     {
-      seg_label_to_sv_list_map_.erase (*filtered_ID_itr);
+      small_segments_.push_back (std::make_pair (segment_size[largest_neigh_seg_label], largest_neigh_seg_label));
+      std::push_heap (small_segments_.begin (), small_segments_.end (), heap_order);
     }
+  }
 
-    // After filtered Segments are deleted, compute completely new adjacency map
-    // NOTE Recomputing the adjacency of every segment in every iteration is an easy but inefficient solution.
-    // Because the number of segments in an average scene is usually well below 1000, the time spend for noise filtering is still neglible in most cases
-    computeSegmentAdjacency ();
-  }  // End while (Filtering)
+  // Write the contracted graph back. The segment adjacency map is rebuilt on request by getSegmentAdjacencyMap.
+  for (uint32_t sv_index = 0; sv_index < nr_vertices; ++sv_index)
+  {
+    uint32_t segment = sv_segments_[sv_index];
+    while (merged_into[segment] != segment)
+      segment = merged_into[segment];
+    merged_into[sv_segments_[sv_index]] = segment;
+    sv_segments_[sv_index] = segment;
+  }
+  buildSegmentMembership (nr_segments);
+  seg_label_to_neighbor_set_map_.clear ();
 }
 
 template <typename PointT> void
@@ -260,45 +485,78 @@ pcl::LCCPSegmentation<PointT>::prepareSegmentation (const std::map<uint32_t, typ
   // Clear internal data
   reset ();
 
-  // Copy map with supervoxel pointers
-  sv_label_to_supervoxel_map_ = supervoxel_clusters_arg;
-
-  //    Build a boost adjacency list from the adjacency multimap
-  std::map<uint32_t, VertexID> label_ID_map;
-
-  // Add all supervoxel labels as vertices
-  for (typename std::map<uint32_t, typename pcl::Supervoxel<PointT>::Ptr>::iterator svlabel_itr = sv_label_to_supervoxel_map_.begin ();
-      svlabel_itr != sv_label_to_supervoxel_map_.end (); ++svlabel_itr)
+  // Give every supervoxel a dense vertex index, in ascending label order, keep its pointer and copy its geometry into the structure-of-arrays buffers
+  const uint32_t max_sv_label = supervoxel_clusters_arg.empty () ? 0 : supervoxel_clusters_arg.rbegin ()->first;
+  sv_label_to_index_.assign (static_cast<size_t> (max_sv_label) + 1, INVALID_INDEX);
+  sv_labels_.reserve (supervoxel_clusters_arg.size ());
+  sv_supervoxels_.reserve (supervoxel_clusters_arg.size ());
+  for (int dim = 0; dim < 3; ++dim)
+  {
+    sv_centroids_[dim].reserve (supervoxel_clusters_arg.size ());
+    sv_normals_[dim].reserve (supervoxel_clusters_arg.size ());
+  }
+  for (typename std::map<uint32_t, typename pcl::Supervoxel<PointT>::Ptr>::const_iterator svlabel_itr = supervoxel_clusters_arg.begin ();
+      svlabel_itr != supervoxel_clusters_arg.end (); ++svlabel_itr)
   {
     const uint32_t& sv_label = svlabel_itr->first;
-    VertexID node_id = boost::add_vertex (sv_adjacency_list_);
-    sv_adjacency_list_[node_id] = sv_label;
-    label_ID_map[sv_label] = node_id;
+    sv_label_to_index_[sv_label] = static_cast<uint32_t> (sv_labels_.size ());
+    sv_labels_.push_back (sv_label);
+    sv_supervoxels_.push_back (svlabel_itr->second);
+
+    const Eigen::Vector3f centroid = svlabel_itr->second->centroid_.getVector3fMap ();
+    const Eigen::Vector3f normal = svlabel_itr->second->normal_.getNormalVector3fMap ().normalized ();
+    for (int dim = 0; dim < 3; ++dim)
+    {
+      sv_centroids_[dim].push_back (centroid[dim]);
+      sv_normals_[dim].push_back (normal[dim]);
+    }
   }
 
-  // Add all edges
+  // Collect every undirected edge once, the adjacency multimap usually holds both directions
+  edge_vertices_.reserve (label_adjaceny_arg.size ());
   for (std::multimap<uint32_t, uint32_t>::const_iterator sv_neighbors_itr = label_adjaceny_arg.begin (); sv_neighbors_itr != label_adjaceny_arg.end ();
       ++sv_neighbors_itr)
   {
-    const uint32_t& sv_label = sv_neighbors_itr->first;
-    const uint32_t& neighbor_label = sv_neighbors_itr->second;
+    const uint32_t u = svIndex (sv_neighbors_itr->first);
+    const uint32_t v = svIndex (sv_neighbors_itr->second);
+    if (u == INVALID_INDEX || v == INVALID_INDEX || u == v)
+      continue;
 
-    VertexID u = label_ID_map[sv_label];
-    VertexID v = label_ID_map[neighbor_label];
-    
-    boost::add_edge (u, v, sv_adjacency_list_);
+    edge_vertices_.push_back (std::make_pair (std::min (u, v), std::max (u, v)));
   }
-
-  // Initialization
-  // clear the processed_ map
-  seg_label_to_sv_list_map_.clear ();
-  for (typename std::map<uint32_t, typename pcl::Supervoxel<PointT>::Ptr>::iterator svlabel_itr = sv_label_to_supervoxel_map_.begin ();
-      svlabel_itr != sv_label_to_supervoxel_map_.end (); ++svlabel_itr)
+  std::sort (edge_vertices_.begin (), edge_vertices_.end ());
+  edge_vertices_.erase (std::unique (edge_vertices_.begin (), edge_vertices_.end ()), edge_vertices_.end ());
+  edge_properties_.resize (edge_vertices_.size ());
+
+  // Build the compressed adjacency. Since the edges are sorted, every neighbor list ends up sorted by vertex index.
+  const uint32_t nr_vertices = static_cast<uint32_t> (sv_labels_.size ());
+  adjacency_offsets_.assign (nr_vertices + 1, 0);
+  for (size_t edge_index = 0; edge_index < edge_vertices_.size (); ++edge_index)
   {
-    const uint32_t& sv_label = svlabel_itr->first;
-    processed_[sv_label] = false;
-    sv_label_to_seg_label_map_[sv_label] = 0;
+    ++adjacency_offsets_[edge_vertices_[edge_index].first + 1];
+    ++adjacency_offsets_[edge_vertices_[edge_index].second + 1];
   }
+  for (uint32_t sv_index = 0; sv_index < nr_vertices; ++sv_index)
+    adjacency_offsets_[sv_index + 1] += adjacency_offsets_[sv_index];
+
+  adjacency_neighbors_.resize (adjacency_offsets_[nr_vertices]);
+  adjacency_edges_.resize (adjacency_offsets_[nr_vertices]);
+  uint32_t* fill_position = scratch_.allocate<uint32_t> (nr_vertices);
+  std::copy (adjacency_offsets_.begin (), adjacency_offsets_.end () - 1, fill_position);
+  for (uint32_t edge_index = 0; edge_index < edge_vertices_.size (); ++edge_index)
+  {
+    const uint32_t u = edge_vertices_[edge_index].first;
+    const uint32_t v = edge_vertices_[edge_index].second;
+
+    adjacency_neighbors_[fill_position[u]] = v;
+    adjacency_edges_[fill_position[u]++] = edge_index;
+
+    adjacency_neighbors_[fill_position[v]] = u;
+    adjacency_edges_[fill_position[v]++] = edge_index;
+  }
+
+  // Initialization
+  sv_segments_.assign (nr_vertices, 0);
 }
 
 
@@ -307,64 +565,67 @@ pcl::LCCPSegmentation<PointT>::prepareSegmentation (const std::map<uint32_t, typ
 template <typename PointT> void
 pcl::LCCPSegmentation<PointT>::doGrouping ()
 {
-  // clear the processed_ map
-  seg_label_to_sv_list_map_.clear ();
-  for (typename std::map<uint32_t, typename pcl::Supervoxel<PointT>::Ptr>::iterator svlabel_itr = sv_label_to_supervoxel_map_.begin ();
-      svlabel_itr != sv_label_to_supervoxel_map_.end (); ++svlabel_itr)
+  const uint32_t nr_vertices = static_cast<uint32_t> (sv_labels_.size ());
+  seg_label_to_neighbor_set_map_.clear ();
+
+  // Join all supervoxels connected by a valid edge
+  sv_sets_.reset (nr_vertices);
+  for (size_t edge_index = 0; edge_index < edge_vertices_.size (); ++edge_index)
   {
-    const uint32_t& sv_label = svlabel_itr->first;
-    processed_[sv_label] = false;
-    sv_label_to_seg_label_map_[sv_label] = 0;
+    if (edge_properties_[edge_index].is_valid)
+      sv_sets_.unite (edge_vertices_[edge_index].first, edge_vertices_[edge_index].second);
   }
-  
-  // Perform depth search on the graph and recursively group all supervoxels with convex connections
-  //The vertices in the supervoxel adjacency list are the supervoxel centroids
-  std::pair< VertexIterator, VertexIterator> vertex_iterator_range;
-  vertex_iterator_range = boost::vertices (sv_adjacency_list_);
 
-  // Note: *sv_itr is of type " boost::graph_traits<VoxelAdjacencyList>::vertex_descriptor " which it nothing but a typedef of size_t..
+  // Compact the set representatives to segment labels in a single pass. Labels are handed out in vertex order,
+  // which is the numbering a depth search started from every unvisited vertex in turn would produce.
+  uint32_t* root_segment_label = scratch_.allocate<uint32_t> (nr_vertices, 0);
   unsigned int segment_label = 1;  // This starts at 1, because 0 is reserved for errors
-  for (VertexIterator sv_itr = vertex_iterator_range.first; sv_itr != vertex_iterator_range.second; ++sv_itr)  // For all supervoxels
+  for (uint32_t sv_index = 0; sv_index < nr_vertices; ++sv_index)  // For all supervoxels
   {
-    const VertexID sv_vertex_id = *sv_itr;
-    const uint32_t& sv_label = sv_adjacency_list_[sv_vertex_id];
-    if (!processed_[sv_label])
-    {
-      // Add neighbors (and their neighbors etc.) to group if similarity constraint is met
-      recursiveSegmentGrowing (sv_vertex_id, segment_label);
-      ++segment_label;  // After recursive grouping ended (no more neighbors to consider) -> go to next group
-    }
+    const uint32_t root = sv_sets_.find (sv_index);
+    if (root_segment_label[root] == 0)
+      root_segment_label[root] = segment_label++;
+
+    sv_segments_[sv_index] = root_segment_label[root];
   }
+  buildSegmentMembership (segment_label - 1);
 }
 
 template <typename PointT> void
-pcl::LCCPSegmentation<PointT>::recursiveSegmentGrowing (const VertexID &query_point_id,
-                                                        const unsigned int segment_label)
+pcl::LCCPSegmentation<PointT>::buildRelabelTable ()
 {
-  const uint32_t& sv_label = sv_adjacency_list_[query_point_id];
-
-  processed_[sv_label] = true;
-
-  // The next two lines add the supervoxel to the segment
-  sv_label_to_seg_label_map_[sv_label] = segment_label;
-  seg_label_to_sv_list_map_[segment_label].insert (sv_label);
+  sv_label_to_seg_label_.assign (sv_label_to_index_.size (), 0);
+  for (size_t sv_index = 0; sv_index < sv_labels_.size (); ++sv_index)
+    sv_label_to_seg_label_[sv_labels_[sv_index]] = sv_segments_[sv_index];
+}
 
-  // Iterate through all neighbors of this supervoxel and check wether they should be merged with the current supervoxel
-  std::pair<OutEdgeIterator, OutEdgeIterator> out_edge_iterator_range;
-  out_edge_iterator_range = boost::out_edges (query_point_id, sv_adjacency_list_);  // adjacent vertices to node (*itr) in graph sv_adjacency_list_
-  for (OutEdgeIterator out_Edge_itr = out_edge_iterator_range.first; out_Edge_itr != out_edge_iterator_range.second; ++out_Edge_itr)
+template <typename PointT> template <typename LabelT> void
+pcl::LCCPSegmentation<PointT>::relabelToBuffer (const pcl::PointCloud<pcl::PointXYZL> &labeled_cloud_arg,
+                                                LabelT* labels_arg) const
+{
+  // One table lookup per point. The points are 32 bytes apart, so the loop is bound by memory rather than arithmetic and is only split over threads.
+  Parallel::forRange (0, labeled_cloud_arg.size (), nr_threads_, [&] (const size_t begin, const size_t end, const unsigned int)
   {
-    const VertexID neighbor_ID = boost::target (*out_Edge_itr, sv_adjacency_list_);
-    const uint32_t& neighbor_label = sv_adjacency_list_[neighbor_ID];
+    for (size_t point_index = begin; point_index < end; ++point_index)
+      labels_arg[point_index] = static_cast<LabelT> (segLabel (labeled_cloud_arg[point_index].label));
+  }, 4096);
+}
 
-    if (!processed_[neighbor_label])  // If neighbor was not already processed
-    {
-      if (sv_adjacency_list_[*out_Edge_itr].is_valid)
-      {
-        recursiveSegmentGrowing (neighbor_ID, segment_label);
-      }
-    }
-  }  // End neighbor loop
+template <typename PointT> void
+pcl::LCCPSegmentation<PointT>::buildSegmentMembership (const uint32_t max_seg_label_arg)
+{
+  // Counting sort of the supervoxels by segment. Walking the vertices in order keeps the labels ascending within every segment.
+  segment_sv_offsets_.assign (static_cast<size_t> (max_seg_label_arg) + 2, 0);
+  for (size_t sv_index = 0; sv_index < sv_segments_.size (); ++sv_index)
+    ++segment_sv_offsets_[sv_segments_[sv_index] + 1];
+  for (uint32_t seg_label = 0; seg_label <= max_seg_label_arg; ++seg_label)
+    segment_sv_offsets_[seg_label + 1] += segment_sv_offsets_[seg_label];
+
+  segment_svs_.resize (sv_segments_.size ());
+  uint32_t* fill_position = scratch_.allocate<uint32_t> (max_seg_label_arg + 1);
+  std::copy (segment_sv_offsets_.begin (), segment_sv_offsets_.end () - 1, fill_position);
+  for (size_t sv_index = 0; sv_index < sv_segments_.size (); ++sv_index)
+    segment_svs_[fill_position[sv_segments_[sv_index]]++] = sv_labels_[sv_index];
 }
 
 template <typename PointT> void
@@ -373,96 +634,290 @@ pcl::LCCPSegmentation<PointT>::applyKconvexity (const unsigned int k_arg)
   if (k_arg == 0)
     return;
 
-  bool is_convex;
-  unsigned int kcount = 0;
+  // Keep only the convex neighbors of every vertex. The compressed adjacency is sorted, so these lists are sorted as well.
+  const uint32_t nr_vertices = static_cast<uint32_t> (sv_labels_.size ());
+  uint32_t* convex_offsets = scratch_.allocate<uint32_t> (nr_vertices + 1, 0);
+  uint32_t* convex_neighbors = scratch_.allocate<uint32_t> (adjacency_neighbors_.size ());
+  uint32_t nr_convex_neighbors = 0;
+  for (uint32_t sv_index = 0; sv_index < nr_vertices; ++sv_index)
+  {
+    for (uint32_t neighbor_itr = adjacency_offsets_[sv_index]; neighbor_itr < adjacency_offsets_[sv_index + 1]; ++neighbor_itr)
+    {
+      if (edge_properties_[adjacency_edges_[neighbor_itr]].is_convex)
+        convex_neighbors[nr_convex_neighbors++] = adjacency_neighbors_[neighbor_itr];
+    }
+    convex_offsets[sv_index + 1] = nr_convex_neighbors;
+  }
 
-  EdgeIterator edge_itr, edge_itr_end, next_edge;
-  boost::tie (edge_itr, edge_itr_end) = boost::edges (sv_adjacency_list_);
+  // Count common convex neighbors of every convex edge by intersecting the sorted lists. Results are only recorded here
+  // and applied afterwards, so the outcome does not depend on how the edges are distributed over the threads.
+  uint8_t* is_k_convex = scratch_.allocate<uint8_t> (edge_vertices_.size (), 1);
+  Parallel::forRange (0, edge_vertices_.size (), nr_threads_, [&] (const size_t begin, const size_t end, const unsigned int)
+  {
+    for (size_t edge_index = begin; edge_index < end; ++edge_index)
+    {
+      if (!edge_properties_[edge_index].is_convex)  // Only (0-)convex edges are checked
+        continue;
 
-  std::pair<OutEdgeIterator, OutEdgeIterator> source_neighbors_range;
-  std::pair<OutEdgeIterator, OutEdgeIterator> target_neighbors_range;
+      const uint32_t source = edge_vertices_[edge_index].first;
+      const uint32_t target = edge_vertices_[edge_index].second;
 
-  // Check all edges in the graph for k-convexity
-  for (next_edge = edge_itr; edge_itr != edge_itr_end; edge_itr = next_edge)
-  {
-    next_edge++;  // next_edge iterator is neccessary, because removing an edge invalidates the iterator to the current edge
+      unsigned int kcount = 0;
+      uint32_t source_itr = convex_offsets[source];
+      uint32_t target_itr = convex_offsets[target];
+      while (source_itr < convex_offsets[source + 1] && target_itr < convex_offsets[target + 1] && kcount < k_arg)
+      {
+        if (convex_neighbors[source_itr] < convex_neighbors[target_itr])
+          ++source_itr;
+        else if (convex_neighbors[target_itr] < convex_neighbors[source_itr])
+          ++target_itr;
+        else  // Common neighbor with a convex connection to both
+        {
+          ++kcount;
+          ++source_itr;
+          ++target_itr;
+        }
+      }
+
+      if (kcount < k_arg)
+        is_k_convex[edge_index] = 0;
+    }
+  }, 256);
 
-    is_convex = sv_adjacency_list_[*edge_itr].is_convex;
+  for (size_t edge_index = 0; edge_index < edge_vertices_.size (); ++edge_index)
+  {
+    if (!is_k_convex[edge_index])
+      edge_properties_[edge_index].is_valid = false;
+  }
+}
 
-    if (is_convex)  // If edge is (0-)convex
+template <typename PointT> void
+pcl::LCCPSegmentation<PointT>::calculateConvexConnections ()
+{
+  // Every edge is written by exactly one thread and the classification only reads shared state, so no locking is needed
+  Parallel::forRange (0, edge_vertices_.size (), nr_threads_, [this] (const size_t begin, const size_t end, const unsigned int)
+  {
+    if (use_vectorized_convexity_)
     {
-      kcount = 0;
+      classifyEdgesVectorized (begin, end);
+      return;
+    }
 
-      const VertexID source = boost::source (*edge_itr, sv_adjacency_list_);
-      const VertexID target = boost::target (*edge_itr, sv_adjacency_list_);
+    for (size_t edge_index = begin; edge_index < end; ++edge_index)
+    {
+      uint32_t source_sv_label = sv_labels_[edge_vertices_[edge_index].first];
+      uint32_t target_sv_label = sv_labels_[edge_vertices_[edge_index].second];
+
+      float normal_difference;
+      bool is_convex = connIsConvex (source_sv_label, target_sv_label, normal_difference);
+      edge_properties_[edge_index].is_convex = is_convex;
+      edge_properties_[edge_index].is_valid = is_convex;
+      edge_properties_[edge_index].normal_difference = normal_difference;
+    }
+  }, 256);
+}
 
-      source_neighbors_range = boost::out_edges (source, sv_adjacency_list_);
-      target_neighbors_range = boost::out_edges (target, sv_adjacency_list_);
+template <typename PointT> void
+pcl::LCCPSegmentation<PointT>::classifyEdgesVectorized (const size_t begin_arg,
+                                                        const size_t end_arg)
+{
+  size_t edge_index = begin_arg;
 
-      // Find common neighbors, check their connection
-      for (OutEdgeIterator source_neighbors_itr = source_neighbors_range.first; source_neighbors_itr != source_neighbors_range.second; ++source_neighbors_itr)  // For all supervoxels
+#ifdef __AVX__
+  // Eight edges per step, the SSE loop below then takes a remaining group of four
+  {
+    const __m256 rad_to_deg = _mm256_set1_ps (static_cast<float> (180. / M_PI));
+    const __m256 zero = _mm256_setzero_ps ();
+    const __m256 concavity_threshold = _mm256_set1_ps (concavity_tolerance_threshold_);
+    const __m256 seed_resolution = _mm256_set1_ps (seed_resolution_);
+    const __m256 dist_smoothing = _mm256_set1_ps (smoothness_threshold_ * voxel_resolution_);
+    const __m256 all_lanes = _mm256_castsi256_ps (_mm256_set1_epi32 (-1));
+
+    for (; edge_index + 8 <= end_arg; edge_index += 8)
+    {
+      const std::pair<uint32_t, uint32_t>* edges = &edge_vertices_[edge_index];
+      __m256 source_centroid[3], target_centroid[3], source_normal[3], target_normal[3];
+      for (int dim = 0; dim < 3; ++dim)
       {
-        VertexID source_neighbor_ID = boost::target (*source_neighbors_itr, sv_adjacency_list_);
+        const float* centroids = &sv_centroids_[dim][0];
+        const float* normals = &sv_normals_[dim][0];
+        source_centroid[dim] = _mm256_setr_ps (centroids[edges[0].first], centroids[edges[1].first], centroids[edges[2].first], centroids[edges[3].first],
+                                               centroids[edges[4].first], centroids[edges[5].first], centroids[edges[6].first], centroids[edges[7].first]);
+        target_centroid[dim] = _mm256_setr_ps (centroids[edges[0].second], centroids[edges[1].second], centroids[edges[2].second], centroids[edges[3].second],
+                                               centroids[edges[4].second], centroids[edges[5].second], centroids[edges[6].second], centroids[edges[7].second]);
+        source_normal[dim] = _mm256_setr_ps (normals[edges[0].first], normals[edges[1].first], normals[edges[2].first], normals[edges[3].first],
+                                             normals[edges[4].first], normals[edges[5].first], normals[edges[6].first], normals[edges[7].first]);
+        target_normal[dim] = _mm256_setr_ps (normals[edges[0].second], normals[edges[1].second], normals[edges[2].second], normals[edges[3].second],
+                                             normals[edges[4].second], normals[edges[5].second], normals[edges[6].second], normals[edges[7].second]);
+      }
 
-        for (OutEdgeIterator target_neighbors_itr = target_neighbors_range.first; target_neighbors_itr != target_neighbors_range.second; ++target_neighbors_itr)  // For all supervoxels
-        {
-          VertexID target_neighbor_ID = boost::target (*target_neighbors_itr, sv_adjacency_list_);
-          if (source_neighbor_ID == target_neighbor_ID)  // Common neighbor
-          {
-            EdgeID src_edge = boost::edge (source, source_neighbor_ID, sv_adjacency_list_).first;
-            EdgeID tar_edge = boost::edge (target, source_neighbor_ID, sv_adjacency_list_).first;
+      const __m256 normal_angle = _mm256_mul_ps (AVXMath::acos (AVXMath::dot (source_normal[0], source_normal[1], source_normal[2],
+                                                                              target_normal[0], target_normal[1], target_normal[2])), rad_to_deg);
 
-            bool src_is_convex = (sv_adjacency_list_)[src_edge].is_convex;
-            bool tar_is_convex = (sv_adjacency_list_)[tar_edge].is_convex;
+      const __m256 vec_t_to_s[3] = {_mm256_sub_ps (source_centroid[0], target_centroid[0]),
+                                    _mm256_sub_ps (source_centroid[1], target_centroid[1]),
+                                    _mm256_sub_ps (source_centroid[2], target_centroid[2])};
 
-            if (src_is_convex && tar_is_convex)
-              ++kcount;
+      const __m256 ncross[3] = {_mm256_sub_ps (_mm256_mul_ps (source_normal[1], target_normal[2]), _mm256_mul_ps (source_normal[2], target_normal[1])),
+                                _mm256_sub_ps (_mm256_mul_ps (source_normal[2], target_normal[0]), _mm256_mul_ps (source_normal[0], target_normal[2])),
+                                _mm256_sub_ps (_mm256_mul_ps (source_normal[0], target_normal[1]), _mm256_mul_ps (source_normal[1], target_normal[0]))};
+      const __m256 ncross_norm = _mm256_sqrt_ps (AVXMath::dot (ncross[0], ncross[1], ncross[2], ncross[0], ncross[1], ncross[2]));
 
-            break;
-          }
-        }
+      const __m256 dot_source = AVXMath::dot (vec_t_to_s[0], vec_t_to_s[1], vec_t_to_s[2], source_normal[0], source_normal[1], source_normal[2]);
+      const __m256 dot_target = AVXMath::dot (vec_t_to_s[0], vec_t_to_s[1], vec_t_to_s[2], target_normal[0], target_normal[1], target_normal[2]);
+
+      __m256 is_convex = all_lanes;
 
-        if (kcount >= k_arg)  // Connection is k-convex, stop search
-          break;
+      if (use_smoothness_check_)
+      {
+        const __m256 expected_distance = _mm256_mul_ps (ncross_norm, seed_resolution);
+        const __m256 point_dist = _mm256_min_ps (AVXMath::abs (dot_source), AVXMath::abs (dot_target));
+        is_convex = _mm256_andnot_ps (_mm256_cmp_ps (point_dist, _mm256_add_ps (expected_distance, dist_smoothing), _CMP_GT_OQ), is_convex);
       }
 
-      // Check k convexity
-      if (kcount < k_arg)
-        (sv_adjacency_list_)[*edge_itr].is_valid = false;
+      if (use_sanity_check_)
+      {
+        const __m256 vec_norm = _mm256_sqrt_ps (AVXMath::dot (vec_t_to_s[0], vec_t_to_s[1], vec_t_to_s[2], vec_t_to_s[0], vec_t_to_s[1], vec_t_to_s[2]));
+        const __m256 denominator = _mm256_mul_ps (ncross_norm, vec_norm);
+        const __m256 intersection_cos = AVXMath::select (_mm256_cmp_ps (denominator, zero, _CMP_GT_OQ),
+                                                         _mm256_div_ps (AVXMath::dot (ncross[0], ncross[1], ncross[2], vec_t_to_s[0], vec_t_to_s[1], vec_t_to_s[2]), denominator),
+                                                         zero);
+
+        const __m256 min_intersect_angle = _mm256_mul_ps (AVXMath::acos (AVXMath::abs (intersection_cos)), rad_to_deg);
+        const __m256 intersect_thresh = _mm256_div_ps (_mm256_set1_ps (60.f),
+                                                       _mm256_add_ps (_mm256_set1_ps (1.f), AVXMath::exp (_mm256_mul_ps (_mm256_set1_ps (-0.25f), _mm256_sub_ps (normal_angle, _mm256_set1_ps (25.f))))));
+        is_convex = _mm256_andnot_ps (_mm256_cmp_ps (min_intersect_angle, intersect_thresh, _CMP_LT_OQ), is_convex);
+      }
+
+      const __m256 is_convex_connection = _mm256_cmp_ps (dot_source, dot_target, _CMP_GE_OQ);
+      is_convex = _mm256_and_ps (is_convex, _mm256_or_ps (is_convex_connection, _mm256_cmp_ps (normal_angle, concavity_threshold, _CMP_LT_OQ)));
+
+      if (concavity_tolerance_threshold_ < 0)
+        is_convex = zero;
+
+      const int convex_mask = _mm256_movemask_ps (is_convex);
+      float normal_difference[8];
+      _mm256_storeu_ps (normal_difference, normal_angle);
+      for (int lane = 0; lane < 8; ++lane)
+      {
+        EdgeProperties& edge_properties = edge_properties_[edge_index + lane];
+        edge_properties.is_convex = (convex_mask >> lane) & 1;
+        edge_properties.is_valid = edge_properties.is_convex;
+        edge_properties.normal_difference = normal_difference[lane];
+      }
     }
   }
-}
+#endif
 
-template <typename PointT> void
-pcl::LCCPSegmentation<PointT>::calculateConvexConnections (SupervoxelAdjacencyList& adjacency_list_arg)
-{
-  bool is_convex;
-
-  EdgeIterator edge_itr, edge_itr_end, next_edge;
-  boost::tie (edge_itr, edge_itr_end) = boost::edges (adjacency_list_arg);
+#ifdef __SSE2__
+  const __m128 rad_to_deg = _mm_set1_ps (static_cast<float> (180. / M_PI));
+  const __m128 zero = _mm_setzero_ps ();
+  const __m128 concavity_threshold = _mm_set1_ps (concavity_tolerance_threshold_);
+  const __m128 seed_resolution = _mm_set1_ps (seed_resolution_);
+  const __m128 dist_smoothing = _mm_set1_ps (smoothness_threshold_ * voxel_resolution_);
+  const __m128 all_lanes = _mm_castsi128_ps (_mm_set1_epi32 (-1));
 
-  for (next_edge = edge_itr; edge_itr != edge_itr_end; edge_itr = next_edge)
+  for (; edge_index + 4 <= end_arg; edge_index += 4)
   {
-    next_edge++;  // next_edge iterator is neccessary, because removing an edge invalidates the iterator to the current edge
+    // Gather the geometry of both end points of the four edges
+    __m128 source_centroid[3], target_centroid[3], source_normal[3], target_normal[3];
+    for (int dim = 0; dim < 3; ++dim)
+    {
+      const float* centroids = &sv_centroids_[dim][0];
+      const float* normals = &sv_normals_[dim][0];
+      source_centroid[dim] = _mm_setr_ps (centroids[edge_vertices_[edge_index].first], centroids[edge_vertices_[edge_index + 1].first],
+                                          centroids[edge_vertices_[edge_index + 2].first], centroids[edge_vertices_[edge_index + 3].first]);
+      target_centroid[dim] = _mm_setr_ps (centroids[edge_vertices_[edge_index].second], centroids[edge_vertices_[edge_index + 1].second],
+                                          centroids[edge_vertices_[edge_index + 2].second], centroids[edge_vertices_[edge_index + 3].second]);
+      source_normal[dim] = _mm_setr_ps (normals[edge_vertices_[edge_index].first], normals[edge_vertices_[edge_index + 1].first],
+                                        normals[edge_vertices_[edge_index + 2].first], normals[edge_vertices_[edge_index + 3].first]);
+      target_normal[dim] = _mm_setr_ps (normals[edge_vertices_[edge_index].second], normals[edge_vertices_[edge_index + 1].second],
+                                        normals[edge_vertices_[edge_index + 2].second], normals[edge_vertices_[edge_index + 3].second]);
+    }
+
+    // The normals are unit length (or zero), so the angle between them is the arc cosine of their dot product
+    const __m128 normal_angle = _mm_mul_ps (SSEMath::acos (SSEMath::dot (source_normal[0], source_normal[1], source_normal[2],
+                                                                         target_normal[0], target_normal[1], target_normal[2])), rad_to_deg);
+
+    const __m128 vec_t_to_s[3] = {_mm_sub_ps (source_centroid[0], target_centroid[0]),
+                                  _mm_sub_ps (source_centroid[1], target_centroid[1]),
+                                  _mm_sub_ps (source_centroid[2], target_centroid[2])};
 
-    uint32_t source_sv_label = adjacency_list_arg[boost::source (*edge_itr, adjacency_list_arg)];
-    uint32_t target_sv_label = adjacency_list_arg[boost::target (*edge_itr, adjacency_list_arg)];
+    const __m128 ncross[3] = {_mm_sub_ps (_mm_mul_ps (source_normal[1], target_normal[2]), _mm_mul_ps (source_normal[2], target_normal[1])),
+                              _mm_sub_ps (_mm_mul_ps (source_normal[2], target_normal[0]), _mm_mul_ps (source_normal[0], target_normal[2])),
+                              _mm_sub_ps (_mm_mul_ps (source_normal[0], target_normal[1]), _mm_mul_ps (source_normal[1], target_normal[0]))};
+    const __m128 ncross_norm = _mm_sqrt_ps (SSEMath::dot (ncross[0], ncross[1], ncross[2], ncross[0], ncross[1], ncross[2]));
 
+    const __m128 dot_source = SSEMath::dot (vec_t_to_s[0], vec_t_to_s[1], vec_t_to_s[2], source_normal[0], source_normal[1], source_normal[2]);
+    const __m128 dot_target = SSEMath::dot (vec_t_to_s[0], vec_t_to_s[1], vec_t_to_s[2], target_normal[0], target_normal[1], target_normal[2]);
+
+    __m128 is_convex = all_lanes;
+
+    // Smoothness Check: Check if there is a step between adjacent patches
+    if (use_smoothness_check_)
+    {
+      const __m128 expected_distance = _mm_mul_ps (ncross_norm, seed_resolution);
+      const __m128 point_dist = _mm_min_ps (SSEMath::abs (dot_source), SSEMath::abs (dot_target));
+      is_convex = _mm_andnot_ps (_mm_cmpgt_ps (point_dist, _mm_add_ps (expected_distance, dist_smoothing)), is_convex);
+    }
+
+    // Sanity Criterion: Check if definition convexity/concavity makes sense for connection of given patches
+    if (use_sanity_check_)
+    {
+      // A zero length vector has no direction, its angle to anything counts as 90 deg like in getAngle3D
+      const __m128 vec_norm = _mm_sqrt_ps (SSEMath::dot (vec_t_to_s[0], vec_t_to_s[1], vec_t_to_s[2], vec_t_to_s[0], vec_t_to_s[1], vec_t_to_s[2]));
+      const __m128 denominator = _mm_mul_ps (ncross_norm, vec_norm);
+      const __m128 intersection_cos = SSEMath::select (_mm_cmpgt_ps (denominator, zero),
+                                                       _mm_div_ps (SSEMath::dot (ncross[0], ncross[1], ncross[2], vec_t_to_s[0], vec_t_to_s[1], vec_t_to_s[2]), denominator),
+                                                       zero);
+
+      // min (angle, 180 - angle) is the angle belonging to the absolute cosine
+      const __m128 min_intersect_angle = _mm_mul_ps (SSEMath::acos (SSEMath::abs (intersection_cos)), rad_to_deg);
+      const __m128 intersect_thresh = _mm_div_ps (_mm_set1_ps (60.f),
+                                                  _mm_add_ps (_mm_set1_ps (1.f), SSEMath::exp (_mm_mul_ps (_mm_set1_ps (-0.25f), _mm_sub_ps (normal_angle, _mm_set1_ps (25.f))))));
+      is_convex = _mm_andnot_ps (_mm_cmplt_ps (min_intersect_angle, intersect_thresh), is_convex);
+    }
+
+    // Convexity Criterion: the source normal is at most as inclined to vec_t_to_s as the target normal. With unit normals comparing the dot products is equivalent to comparing the angles.
+    // Concave connections will be accepted if difference of normals is small
+    const __m128 is_convex_connection = _mm_cmpge_ps (dot_source, dot_target);
+    is_convex = _mm_and_ps (is_convex, _mm_or_ps (is_convex_connection, _mm_cmplt_ps (normal_angle, concavity_threshold)));
+
+    //NOTE For angles below 0 nothing will be merged
+    if (concavity_tolerance_threshold_ < 0)
+      is_convex = zero;
+
+    const int convex_mask = _mm_movemask_ps (is_convex);
+    float normal_difference[4];
+    _mm_storeu_ps (normal_difference, normal_angle);
+    for (int lane = 0; lane < 4; ++lane)
+    {
+      EdgeProperties& edge_properties = edge_properties_[edge_index + lane];
+      edge_properties.is_convex = (convex_mask >> lane) & 1;
+      edge_properties.is_valid = edge_properties.is_convex;
+      edge_properties.normal_difference = normal_difference[lane];
+    }
+  }
+#endif
+
+  // Remaining edges that do not fill a whole register, or all edges when built without SSE2
+  for (; edge_index < end_arg; ++edge_index)
+  {
     float normal_difference;
-    is_convex = connIsConvex (source_sv_label, target_sv_label, normal_difference);
-    adjacency_list_arg[*edge_itr].is_convex = is_convex;
-    adjacency_list_arg[*edge_itr].is_valid = is_convex;
-    adjacency_list_arg[*edge_itr].normal_difference = normal_difference;
+    const bool is_convex = connIsConvex (sv_labels_[edge_vertices_[edge_index].first], sv_labels_[edge_vertices_[edge_index].second], normal_difference);
+    edge_properties_[edge_index].is_convex = is_convex;
+    edge_properties_[edge_index].is_valid = is_convex;
+    edge_properties_[edge_index].normal_difference = normal_difference;
   }
 }
 
 template <typename PointT> bool
 pcl::LCCPSegmentation<PointT>::connIsConvex (const uint32_t source_label_arg,
                                              const uint32_t target_label_arg,
-                                             float &normal_angle)
+                                             float &normal_angle) const
 {
-  typename pcl::Supervoxel<PointT>::Ptr& sv_source = sv_label_to_supervoxel_map_[source_label_arg];
-  typename pcl::Supervoxel<PointT>::Ptr& sv_target = sv_label_to_supervoxel_map_[target_label_arg];
+  const typename pcl::Supervoxel<PointT>::Ptr& sv_source = sv_supervoxels_[svIndex (source_label_arg)];
+  const typename pcl::Supervoxel<PointT>::Ptr& sv_target = sv_supervoxels_[svIndex (target_label_arg)];
 
   const Eigen::Vector3f& source_centroid = sv_source->centroid_.getVector3fMap ();
   const Eigen::Vector3f& target_centroid = sv_target->centroid_.getVector3fMap ();
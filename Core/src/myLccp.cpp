@@ -1,22 +1,18 @@
 #include "myLccp.h"
 
-int myLccp::mySeg( pcl::PointCloud<pcl::PointXYZRGB>::Ptr input_cloud_ptr,
-                   pcl::PointCloud<pcl::PointXYZL>::Ptr& lccp_labeled_cloud)//---------一定要用引用
+void myLccp::segment(pcl::PointCloud<pcl::PointXYZRGB>::Ptr input_cloud_ptr,
+                     pcl::PointCloud<pcl::Normal>::Ptr input_normals_ptr,
+                     pcl::SupervoxelClustering<PointT> & super)
 {
-    normals_scale = seed_resolution / 2.0;
-    if (use_extended_convexity)
-        k_factor = 1;
-
     /// -----------------------------------|  Preparations  |-----------------------------------
 
     /// Create variables needed for preparations
 //    pcl::PointCloud<PointT>::Ptr input_cloud_ptr=input_cloud_ptr1;//(new pcl::PointCloud<PointT>);
-    pcl::PointCloud<pcl::Normal>::Ptr input_normals_ptr(new pcl::PointCloud<pcl::Normal>);
-    bool has_normals = false;
+    //Given normals replace the normal estimation of the supervoxel clustering
+    bool has_normals = input_normals_ptr && input_normals_ptr->size() == input_cloud_ptr->size();
 
     /// Preparation of Input: Supervoxel Oversegmentation
 
-    pcl::SupervoxelClustering<PointT> super(voxel_resolution, seed_resolution);
     super.setUseSingleCameraTransform(use_single_cam_transform);
     super.setInputCloud(input_cloud_ptr);
     if (has_normals)
@@ -45,41 +41,166 @@ int myLccp::mySeg( pcl::PointCloud<pcl::PointXYZRGB>::Ptr input_cloud_ptr,
     /// Get the cloud of supervoxel centroid with normals and the colored cloud with supervoxel coloring (this is used for visulization)
     //pcl::PointCloud<pcl::PointNormal>::Ptr sv_centroid_normal_cloud = pcl::SupervoxelClustering<PointT>::makeSupervoxelNormalCloud(supervoxel_clusters);
 
+    segmentSupervoxels(supervoxel_clusters, supervoxel_adjacency);
+}
+
+pcl::PointCloud<pcl::PointXYZL>::Ptr myLccp::segmentOrganized(pcl::PointCloud<pcl::PointXYZRGB>::Ptr input_cloud_ptr,
+                                                              pcl::PointCloud<pcl::Normal>::Ptr input_normals_ptr,
+                                                              unsigned int seed_step)
+{
+    organized_super.setInputCloud(input_cloud_ptr);
+    organized_super.setNormalCloud(input_normals_ptr);
+    organized_super.setSeedResolution(seed_resolution);
+    organized_super.setSeedStep(seed_step);
+    organized_super.setColorImportance(color_importance);
+    organized_super.setSpatialImportance(spatial_importance);
+    organized_super.setNormalImportance(normal_importance);
+    organized_super.setNumberOfThreads(nr_threads);
+
+    std::map<uint32_t, pcl::Supervoxel<PointT>::Ptr> supervoxel_clusters;
+    organized_super.extract(supervoxel_clusters);
+
+    std::multimap<uint32_t, uint32_t> supervoxel_adjacency;
+    organized_super.getSupervoxelAdjacency(supervoxel_adjacency);
+
+    segmentSupervoxels(supervoxel_clusters, supervoxel_adjacency);
 
+    return organized_super.getLabeledCloud();
+}
 
+void myLccp::segmentSupervoxels(const std::map<uint32_t, pcl::Supervoxel<PointT>::Ptr> & supervoxel_clusters,
+                                const std::multimap<uint32_t, uint32_t> & supervoxel_adjacency)
+{
+    normals_scale = seed_resolution / 2.0;
+    if (use_extended_convexity)
+        k_factor = 1;
 
     /// The Main Step: Perform LCCPSegmentation
 
     //PCL_INFO("Starting Segmentation\n");
-    pcl::LCCPSegmentation<PointT> lccp;
-
     lccp.setConcavityToleranceThreshold(concavity_tolerance_threshold);
 
     lccp.setSanityCheck(use_sanity_criterion);
 
     lccp.setSmoothnessCheck(true, voxel_resolution, seed_resolution, smoothness_threshold);
 
+    lccp.setNumberOfThreads(nr_threads);
+
     //lccp.setKFactor(k_factor);
     lccp.setKFactor(0);
     lccp.setInputSupervoxels(supervoxel_clusters, supervoxel_adjacency);
     //lccp.setMinSegmentSize(min_segment_size);
     lccp.setMinSegmentSize(5);
     lccp.segment();
+}
+
+int myLccp::mySeg( pcl::PointCloud<pcl::PointXYZRGB>::Ptr input_cloud_ptr,
+                   pcl::PointCloud<pcl::PointXYZL>::Ptr& lccp_labeled_cloud)//---------一定要用引用
+{
+    //A cloud passed in is filled in place so its storage is reused
+    if (!lccp_labeled_cloud)
+        lccp_labeled_cloud.reset(new pcl::PointCloud<pcl::PointXYZL>);
+
+    if (use_organized_supervoxels && input_cloud_ptr->isOrganized())
+    {
+        *lccp_labeled_cloud = *segmentOrganized(input_cloud_ptr, pcl::PointCloud<pcl::Normal>::Ptr(), organized_seed_step);
+        return lccp.relabelCloud(*lccp_labeled_cloud);
+    }
+
+    compact(input_cloud_ptr, pcl::PointCloud<pcl::Normal>::Ptr());
+    pcl::SupervoxelClustering<PointT> super(voxel_resolution, seed_resolution);
+    segment(compact_cloud, pcl::PointCloud<pcl::Normal>::Ptr(), super);
 
     //PCL_INFO("Interpolation voxel cloud -> input cloud and relabeling\n");
     pcl::PointCloud<pcl::PointXYZL>::Ptr sv_labeled_cloud = super.getLabeledCloud();
-    //pcl::PointCloud<pcl::PointXYZL>::Ptr lccp_labeled_cloud = sv_labeled_cloud->makeShared();
-    lccp_labeled_cloud= sv_labeled_cloud->makeShared();
-    int aaa=lccp.relabelCloud(*lccp_labeled_cloud);
-    return aaa;
+    int nr_supervoxels = lccp.relabelCloud(*sv_labeled_cloud);
+
+    //Back to the layout of the input, invalid points get label 0
+    lccp_labeled_cloud->resize(input_cloud_ptr->size());
+    lccp_labeled_cloud->width = input_cloud_ptr->width;
+    lccp_labeled_cloud->height = input_cloud_ptr->height;
+    lccp_labeled_cloud->is_dense = false;
+    for (size_t i = 0; i < input_cloud_ptr->size(); i++)
+    {
+        lccp_labeled_cloud->points[i].x = input_cloud_ptr->points[i].x;
+        lccp_labeled_cloud->points[i].y = input_cloud_ptr->points[i].y;
+        lccp_labeled_cloud->points[i].z = input_cloud_ptr->points[i].z;
+        lccp_labeled_cloud->points[i].label = 0;
+    }
+    for (size_t i = 0; i < compact_indices.size(); i++)
+        lccp_labeled_cloud->points[compact_indices[i]].label = sv_labeled_cloud->points[i].label;
+
+    return nr_supervoxels;
+}
+
+int myLccp::mySeg( pcl::PointCloud<pcl::PointXYZRGB>::Ptr input_cloud_ptr, float * labels)
+{
+    return mySeg(input_cloud_ptr, pcl::PointCloud<pcl::Normal>::Ptr(), labels);
+}
 
+int myLccp::mySeg( pcl::PointCloud<pcl::PointXYZRGB>::Ptr input_cloud_ptr,
+                   pcl::PointCloud<pcl::Normal>::Ptr input_normals_ptr,
+                   float * labels)
+{
+    if (use_organized_supervoxels && input_cloud_ptr->isOrganized())
+    {
+        if (pyramid_level == 0)
+            return lccp.relabelCloud(*segmentOrganized(input_cloud_ptr, input_normals_ptr, organized_seed_step), labels);
 
+        //Segment a downsampled copy, the seeds keep their metric spacing so the step shrinks with the image
+        LabelPyramid::downsample(*input_cloud_ptr, input_normals_ptr, pyramid_level, *coarse_cloud, *coarse_normals);
+        unsigned int seed_step = std::max(organized_seed_step >> pyramid_level, 1u);
 
+        coarse_labels.resize(coarse_cloud->size());
+        int nr_supervoxels = lccp.relabelCloud(*segmentOrganized(coarse_cloud, input_normals_ptr ? coarse_normals : pcl::PointCloud<pcl::Normal>::Ptr(), seed_step),
+                                               coarse_labels.data());
 
+        LabelPyramid::upsample(*input_cloud_ptr, *coarse_cloud, coarse_labels.data(), pyramid_level, labels);
 
+        return nr_supervoxels;
+    }
 
+    compact(input_cloud_ptr, input_normals_ptr);
+    pcl::SupervoxelClustering<PointT> super(voxel_resolution, seed_resolution);
+    segment(compact_cloud, input_normals_ptr ? compact_normals : pcl::PointCloud<pcl::Normal>::Ptr(), super);
 
+    //Segment labels go straight from the supervoxel labels into the buffer, no labeled copy of the cloud is made
+    compact_labels.resize(compact_cloud->size());
+    int nr_supervoxels = lccp.relabelCloud(*super.getLabeledCloud(), compact_labels.data());
 
+    //Scatter back to the full resolution label image, invalid points get label 0
+    std::fill(labels, labels + input_cloud_ptr->size(), 0.0f);
+    for (size_t i = 0; i < compact_indices.size(); i++)
+        labels[compact_indices[i]] = compact_labels[i];
 
+    return nr_supervoxels;
 }
 
+void myLccp::compact(pcl::PointCloud<pcl::PointXYZRGB>::ConstPtr input_cloud_ptr,
+                     pcl::PointCloud<pcl::Normal>::ConstPtr input_normals_ptr)
+{
+    compact_cloud->clear();
+    compact_normals->clear();
+    compact_indices.clear();
+
+    for (size_t i = 0; i < input_cloud_ptr->size(); i++)
+    {
+        const PointT & p = input_cloud_ptr->points[i];
+
+        //Pixels without depth come out of vertexBuff as zeros
+        if (pcl_isfinite(p.z) && p.z > 0)
+        {
+            compact_cloud->push_back(p);
+            compact_indices.push_back(i);
+
+            if (input_normals_ptr)
+                compact_normals->push_back(input_normals_ptr->points[i]);
+        }
+    }
+
+    compact_cloud->width = compact_cloud->size();
+    compact_cloud->height = 1;
+    compact_cloud->is_dense = true;
+    compact_normals->width = compact_normals->size();
+    compact_normals->height = 1;
+}
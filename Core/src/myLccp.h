@@ -21,6 +21,8 @@
 
 // The segmentation class this example is for
 #include "lccp.hpp"
+#include "organized_supervoxel_clustering.hpp"
+#include "Utils/LabelPyramid.h"
 
 // VTK
 #include <vtkImageReader2Factory.h>
@@ -39,7 +41,13 @@ typedef pcl::LCCPSegmentation<PointT>::SupervoxelAdjacencyList SuperVoxelAdjacen
 class myLccp{
 
 public:
-    myLccp(){
+    myLccp()
+     : organized_super(0.03f),
+       compact_cloud(new pcl::PointCloud<PointT>),
+       compact_normals(new pcl::PointCloud<pcl::Normal>),
+       coarse_cloud(new pcl::PointCloud<PointT>),
+       coarse_normals(new pcl::PointCloud<pcl::Normal>)
+    {
 
         /// Callback and variables
 
@@ -58,6 +66,9 @@ public:
         normal_importance = 4.0f;
        use_single_cam_transform = false;
        use_supervoxel_refinement = false;
+       use_organized_supervoxels = false;
+       organized_seed_step = 16;
+       pyramid_level = 0;
 
         // LCCPSegmentation Stuff
         concavity_tolerance_threshold = 10;
@@ -67,6 +78,7 @@ public:
         use_sanity_criterion = true;
 
         k_factor = 0;
+        nr_threads = 0;
 
 
     }
@@ -91,6 +103,9 @@ public:
     float normal_importance ;
     bool use_single_cam_transform ;
     bool use_supervoxel_refinement ;
+    bool use_organized_supervoxels ; // organized clouds are clustered on the pixel grid instead of an octree, off until it is validated on recorded frames
+    unsigned int organized_seed_step ; // in pixels
+    unsigned int pyramid_level ; // organized clouds are segmented at 1/2^level resolution, labels are upsampled back
 
     // LCCPSegmentation Stuff
     float concavity_tolerance_threshold ;
@@ -100,15 +115,59 @@ public:
     bool use_sanity_criterion ;
 
     unsigned int k_factor;
+    unsigned int nr_threads; // 0 uses every hardware thread
 
     pcl::visualization::PCLVisualizer::Ptr viewer;
 
+    //Kept between frames so its graph and label storage is reused instead of reallocated,
+    //the PCL supervoxel clustering is still built per frame as PCL does not support reusing it
+    pcl::LCCPSegmentation<PointT> lccp;
+    pcl::OrganizedSupervoxelClustering<PointT> organized_super;
+
+    //Valid points of the last input for the PCL supervoxel path, with the input index of each
+    pcl::PointCloud<PointT>::Ptr compact_cloud;
+    pcl::PointCloud<pcl::Normal>::Ptr compact_normals;
+    std::vector<int> compact_indices;
+    std::vector<float> compact_labels;
+
+    //Downsampled input of the last frame when pyramid_level > 0
+    pcl::PointCloud<PointT>::Ptr coarse_cloud;
+    pcl::PointCloud<pcl::Normal>::Ptr coarse_normals;
+    std::vector<float> coarse_labels;
+
 
 
 public:
     //const pcl::PointCloud<pcl::PointXYZRGB>::ConstPtr
+    //A non-empty lccp_labeled_cloud is overwritten in place, otherwise a new cloud is created
     int mySeg( pcl::PointCloud<pcl::PointXYZRGB>::Ptr ,pcl::PointCloud<pcl::PointXYZL>::Ptr &lccp_labeled_cloud);
 
+    //Writes the segment label of every input point into labels, which must hold input->size() floats.
+    //Points without a valid depth are left out of the clustering and get label 0
+    int mySeg( pcl::PointCloud<pcl::PointXYZRGB>::Ptr input, float * labels);
+
+    //Same with a normal for every input point, e.g. the normal map rendered on the GPU, used instead of estimating normals
+    int mySeg( pcl::PointCloud<pcl::PointXYZRGB>::Ptr input, pcl::PointCloud<pcl::Normal>::Ptr normals, float * labels);
+
+    //Supervoxel clustering followed by LCCP segmentation into lccp, shared by both mySeg variants
+    //normals may be empty, then the clustering estimates them
+    void segment( pcl::PointCloud<pcl::PointXYZRGB>::Ptr input,
+                  pcl::PointCloud<pcl::Normal>::Ptr normals,
+                  pcl::SupervoxelClustering<PointT> & super);
+
+    //Same with organized_super, returns the cloud labeled with supervoxel labels
+    pcl::PointCloud<pcl::PointXYZL>::Ptr segmentOrganized( pcl::PointCloud<pcl::PointXYZRGB>::Ptr input,
+                                                           pcl::PointCloud<pcl::Normal>::Ptr normals,
+                                                           unsigned int seed_step);
+
+    //Copies the points with a valid depth into compact_cloud and their index into compact_indices,
+    //and their normals into compact_normals if there are any
+    void compact( pcl::PointCloud<pcl::PointXYZRGB>::ConstPtr input, pcl::PointCloud<pcl::Normal>::ConstPtr normals);
+
+    //LCCP segmentation of the supervoxels
+    void segmentSupervoxels( const std::map<uint32_t, pcl::Supervoxel<PointT>::Ptr> & supervoxel_clusters,
+                             const std::multimap<uint32_t, uint32_t> & supervoxel_adjacency);
+
 };
 
 
@@ -0,0 +1,280 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2014-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_SEGMENTATION_ORGANIZED_SUPERVOXEL_CLUSTERING_H_
+#define PCL_SEGMENTATION_ORGANIZED_SUPERVOXEL_CLUSTERING_H_
+
+#include <pcl/pcl_base.h>
+#include <pcl/point_types.h>
+#include <pcl/point_cloud.h>
+#include <pcl/segmentation/supervoxel_clustering.h>
+#include <Eigen/StdVector>
+#include <map>
+#include <vector>
+
+namespace pcl
+{
+  /** \brief Supervoxel clustering for organized clouds such as depth frames. Instead of voxelizing the cloud into an octree it works on the pixel grid:
+   *  SLIC-style seeds on a regular lattice, a k-means refinement in which every pixel only chooses between the clusters of its 4-neighbourhood,
+   *  and supervoxel adjacency read straight off the lattice. Neighbouring pixels are only connected if their depth is continuous.
+   *  The output has the same form as \ref SupervoxelClustering, so it can be passed to \ref LCCPSegmentation directly.
+   *  \note Per-pixel storage is kept between calls, so one instance should be reused for every frame.
+   *  \ingroup segmentation
+   */
+  template <typename PointT>
+  class OrganizedSupervoxelClustering
+  {
+    /** \brief Running sums of the pixels of one cluster */
+    struct ClusterSums
+    {
+      Eigen::Vector3f xyz;
+      Eigen::Vector3f rgb;
+      Eigen::Vector3f normal;
+      uint32_t count;
+    };
+
+    /** \brief Mean position, color and normal of one cluster */
+    struct ClusterCenter
+    {
+      Eigen::Vector3f xyz;
+      Eigen::Vector3f rgb;
+      Eigen::Vector3f normal;
+    };
+
+    public:
+
+      /** \brief Constructor
+       *  \param[in] seed_resolution The spatial extent of a supervoxel in [m], used to normalize the spatial distance
+       *  \param[in] seed_step Spacing of the seed lattice in pixels */
+      OrganizedSupervoxelClustering (const float seed_resolution,
+                                     const unsigned int seed_step = 16);
+
+      virtual
+      ~OrganizedSupervoxelClustering ();
+
+      /** \brief Set the input cloud. It has to be organized, points with a non-finite or non-positive z are treated as invalid and get no supervoxel. */
+      inline void
+      setInputCloud (const typename pcl::PointCloud<PointT>::ConstPtr &cloud_arg)
+      {
+        input_ = cloud_arg;
+      }
+
+      /** \brief Set per-pixel normals, e.g. rendered on the GPU, to use instead of estimating them from the lattice. They are oriented towards the origin like the estimated ones.
+       *  \param[in] normal_cloud_arg Organized like the input cloud, an empty pointer goes back to estimating the normals */
+      inline void
+      setNormalCloud (const pcl::PointCloud<pcl::Normal>::ConstPtr &normal_cloud_arg)
+      {
+        input_normals_ = normal_cloud_arg;
+      }
+
+      /** \brief Set the spatial extent of a supervoxel in [m], used to normalize the spatial distance */
+      inline void
+      setSeedResolution (const float seed_resolution_arg)
+      {
+        seed_resolution_ = seed_resolution_arg;
+      }
+
+      /** \brief Set the importance of color for supervoxels */
+      inline void
+      setColorImportance (const float val_arg)
+      {
+        color_importance_ = val_arg;
+      }
+
+      /** \brief Set the importance of spatial distance for supervoxels */
+      inline void
+      setSpatialImportance (const float val_arg)
+      {
+        spatial_importance_ = val_arg;
+      }
+
+      /** \brief Set the importance of the normal angle for supervoxels */
+      inline void
+      setNormalImportance (const float val_arg)
+      {
+        normal_importance_ = val_arg;
+      }
+
+      /** \brief Set the spacing of the seed lattice in pixels */
+      inline void
+      setSeedStep (const unsigned int seed_step_arg)
+      {
+        seed_step_ = std::max (2u, seed_step_arg);
+      }
+
+      /** \brief Set the number of k-means iterations */
+      inline void
+      setNumberOfIterations (const unsigned int nr_iterations_arg)
+      {
+        nr_iterations_ = nr_iterations_arg;
+      }
+
+      /** \brief Two neighbouring pixels are connected if their depth differs by at most this fraction of the smaller depth */
+      inline void
+      setDepthDiscontinuity (const float ratio_arg)
+      {
+        depth_discontinuity_ = ratio_arg;
+      }
+
+      /** \brief Set the number of threads used for the per-pixel passes, 0 means one per hardware thread */
+      inline void
+      setNumberOfThreads (const unsigned int nr_threads_arg)
+      {
+        nr_threads_ = nr_threads_arg;
+      }
+
+      /** \brief Cluster the input cloud into supervoxels
+       *  \param[out] supervoxel_clusters_arg Map of < supervoxel labels, supervoxels >. Labels are consecutive starting at 1. The supervoxels carry centroid and normal, their voxel clouds are left empty. */
+      void
+      extract (std::map<uint32_t, typename pcl::Supervoxel<PointT>::Ptr> &supervoxel_clusters_arg);
+
+      /** \brief Get the adjacency of the supervoxels found by \ref extract. Every adjacent pair is inserted in both directions, like \ref SupervoxelClustering::getSupervoxelAdjacency does. */
+      void
+      getSupervoxelAdjacency (std::multimap<uint32_t, uint32_t> &label_adjacency_arg) const;
+
+      /** \brief Get the input cloud labeled with the supervoxel label of every pixel, 0 for invalid pixels. It is organized like the input.
+       *  \note The cloud is reused by the next call of \ref extract */
+      inline typename pcl::PointCloud<pcl::PointXYZL>::Ptr
+      getLabeledCloud () const
+      {
+        return (labeled_cloud_);
+      }
+
+    protected:
+
+      /** \brief Mark invalid pixels and compute which of the 8 neighbours every pixel is connected to */
+      void
+      computeConnectivity ();
+
+      /** \brief Estimate a normal for every valid pixel from its connected neighbours on the lattice, or take it from \ref input_normals_, oriented towards the camera */
+      void
+      computePixelNormals ();
+
+      /** \brief Compute the cluster centers from the current labels
+       *  \param[in] nr_labels Labels are in [1, nr_labels] */
+      void
+      computeCenters (const uint32_t nr_labels);
+
+      /** \brief One k-means step: every valid pixel moves to the closest cluster among its own and those of its connected 4-neighbours */
+      void
+      assignPixels ();
+
+      /** \brief Split clusters into 4-connected components and merge fragments smaller than a quarter seed cell into an adjacent component
+       *  \return The number of supervoxels, labels are consecutive starting at 1 */
+      uint32_t
+      enforceConnectivity ();
+
+      /** \brief Pixels with a non-finite or non-positive depth carry no measurement */
+      static inline bool
+      isValid (const PointT &point_arg)
+      {
+        return (pcl_isfinite (point_arg.z) && point_arg.z > 0);
+      }
+
+      /** \brief Squared distance between a pixel and a cluster center. Spatial, color and normal distance are weighted by their importance as in \ref SupervoxelClustering,
+       *  but combined as a sum of squares like SLIC, which avoids the square roots. */
+      inline float
+      distance (const size_t pixel_arg,
+                const ClusterCenter &center_arg) const;
+
+      /** \brief Pixel offset of each of the 8 neighbours, in the bit order of \ref links_ */
+      int neighbour_offsets_[8];
+
+      /** \brief The input cloud */
+      typename pcl::PointCloud<PointT>::ConstPtr input_;
+
+      /** \brief Optional per-pixel normals of the input cloud */
+      pcl::PointCloud<pcl::Normal>::ConstPtr input_normals_;
+
+      float seed_resolution_;
+
+      unsigned int seed_step_;
+
+      float color_importance_;
+
+      float spatial_importance_;
+
+      float normal_importance_;
+
+      unsigned int nr_iterations_;
+
+      float depth_discontinuity_;
+
+      unsigned int nr_threads_;
+
+      /** \brief Depth of every pixel, 0 for invalid pixels */
+      std::vector<float> depths_;
+
+      /** \brief The first four bits of \ref links_, computed before the other four are mirrored from them */
+      std::vector<uint8_t> forward_links_;
+
+      /** \brief Bit i is set if the pixel is connected to neighbour i, 0 for invalid pixels */
+      std::vector<uint8_t> links_;
+
+      /** \brief Per-pixel normals, zero where no normal could be estimated */
+      std::vector<Eigen::Vector3f> pixel_normals_;
+
+      /** \brief Cluster label of every pixel, 0 for invalid pixels */
+      std::vector<uint32_t> labels_;
+
+      /** \brief Labels written by \ref assignPixels, swapped with \ref labels_ afterwards */
+      std::vector<uint32_t> next_labels_;
+
+      /** \brief Indexed by label */
+      std::vector<ClusterSums, Eigen::aligned_allocator<ClusterSums> > sums_;
+
+      /** \brief Indexed by label */
+      std::vector<ClusterCenter, Eigen::aligned_allocator<ClusterCenter> > centers_;
+
+      /** \brief Scatter matrix of the pixel positions of every supervoxel around its centroid, used for its plane normal */
+      std::vector<Eigen::Matrix3f> scatter_;
+
+      /** \brief Pixels of the component currently grown by \ref enforceConnectivity */
+      std::vector<uint32_t> component_;
+
+      /** \brief Adjacent supervoxel pairs (smaller label, larger label), sorted and unique */
+      std::vector<std::pair<uint32_t, uint32_t> > adjacency_;
+
+      typename pcl::PointCloud<pcl::PointXYZL>::Ptr labeled_cloud_;
+  };
+}
+
+#ifdef PCL_NO_PRECOMPILE
+#include "organized_supervoxel_clustering.hpp"
+#endif
+
+#endif // PCL_SEGMENTATION_ORGANIZED_SUPERVOXEL_CLUSTERING_H_
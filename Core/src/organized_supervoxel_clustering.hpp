@@ -0,0 +1,517 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2014-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_SEGMENTATION_IMPL_ORGANIZED_SUPERVOXEL_CLUSTERING_HPP_
+#define PCL_SEGMENTATION_IMPL_ORGANIZED_SUPERVOXEL_CLUSTERING_HPP_
+
+#include "organized_supervoxel_clustering.h"
+#include "Utils/Parallel.h"
+
+#include <algorithm>
+#include <Eigen/Eigenvalues>
+
+
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+/////////////////// Public Functions /////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+
+
+
+template <typename PointT>
+pcl::OrganizedSupervoxelClustering<PointT>::OrganizedSupervoxelClustering (const float seed_resolution,
+                                                                          const unsigned int seed_step) :
+  seed_resolution_ (seed_resolution),
+  seed_step_ (std::max (2u, seed_step)),
+  color_importance_ (0.1f),
+  spatial_importance_ (1.0f),
+  normal_importance_ (1.0f),
+  nr_iterations_ (3),
+  depth_discontinuity_ (0.05f),
+  nr_threads_ (1),
+  labeled_cloud_ (new pcl::PointCloud<pcl::PointXYZL>)
+{
+  std::fill (neighbour_offsets_, neighbour_offsets_ + 8, 0);
+}
+
+template <typename PointT>
+pcl::OrganizedSupervoxelClustering<PointT>::~OrganizedSupervoxelClustering ()
+{
+}
+
+template <typename PointT> void
+pcl::OrganizedSupervoxelClustering<PointT>::extract (std::map<uint32_t, typename pcl::Supervoxel<PointT>::Ptr> &supervoxel_clusters_arg)
+{
+  supervoxel_clusters_arg.clear ();
+  adjacency_.clear ();
+
+  if (!input_ || input_->height < 2 || input_->size () != static_cast<size_t> (input_->width) * input_->height)
+  {
+    PCL_ERROR ("[pcl::OrganizedSupervoxelClustering::extract] Input cloud is not organized. Nothing has been done. \n");
+    return;
+  }
+
+  const int width = static_cast<int> (input_->width);
+  const int height = static_cast<int> (input_->height);
+  const size_t nr_pixels = input_->size ();
+
+  // Bit order: right, down-right, down, down-left, left, up-left, up, up-right. The opposite of bit i is bit (i + 4) % 8.
+  const int offsets[8] = {1, width + 1, width, width - 1, -1, -width - 1, -width, -width + 1};
+  std::copy (offsets, offsets + 8, neighbour_offsets_);
+
+  computeConnectivity ();
+  computePixelNormals ();
+
+  // Seed every cell of the lattice with its valid pixels
+  const uint32_t cells_x = (width + seed_step_ - 1) / seed_step_;
+  const uint32_t cells_y = (height + seed_step_ - 1) / seed_step_;
+  labels_.resize (nr_pixels);
+  next_labels_.resize (nr_pixels);
+  for (int row = 0; row < height; ++row)
+  {
+    const uint32_t cell_row = (row / seed_step_) * cells_x;
+    for (int col = 0; col < width; ++col)
+    {
+      const size_t pixel = static_cast<size_t> (row) * width + col;
+      labels_[pixel] = depths_[pixel] > 0 ? cell_row + col / seed_step_ + 1 : 0;
+    }
+  }
+
+  for (unsigned int iteration = 0; iteration < nr_iterations_; ++iteration)
+  {
+    computeCenters (cells_x * cells_y);
+    assignPixels ();
+  }
+
+  const uint32_t nr_supervoxels = enforceConnectivity ();
+
+  // Supervoxel centroid, and plane normal from the scatter of its pixels around the centroid
+  computeCenters (nr_supervoxels);
+  scatter_.assign (nr_supervoxels + 1, Eigen::Matrix3f::Zero ());
+  for (size_t pixel = 0; pixel < nr_pixels; ++pixel)
+  {
+    if (labels_[pixel] != 0)
+    {
+      const Eigen::Vector3f offset = input_->points[pixel].getVector3fMap () - centers_[labels_[pixel]].xyz;
+      scatter_[labels_[pixel]] += offset * offset.transpose ();
+    }
+  }
+
+  for (uint32_t label = 1; label <= nr_supervoxels; ++label)
+  {
+    const ClusterSums &sums = sums_[label];
+    const ClusterCenter &center = centers_[label];
+    typename pcl::Supervoxel<PointT>::Ptr supervoxel (new pcl::Supervoxel<PointT>);
+
+    supervoxel->centroid_.x = center.xyz[0];
+    supervoxel->centroid_.y = center.xyz[1];
+    supervoxel->centroid_.z = center.xyz[2];
+    supervoxel->centroid_.r = static_cast<uint8_t> (center.rgb[0] + 0.5f);
+    supervoxel->centroid_.g = static_cast<uint8_t> (center.rgb[1] + 0.5f);
+    supervoxel->centroid_.b = static_cast<uint8_t> (center.rgb[2] + 0.5f);
+
+    Eigen::Vector3f normal = center.normal;
+    float curvature = 0;
+    if (sums.count >= 3)
+    {
+      Eigen::SelfAdjointEigenSolver<Eigen::Matrix3f> solver;
+      solver.computeDirect (scatter_[label] / static_cast<float> (sums.count));
+      const float eigen_sum = solver.eigenvalues ().sum ();
+      if (eigen_sum > 0)
+      {
+        normal = solver.eigenvectors ().col (0);
+        curvature = solver.eigenvalues ()[0] / eigen_sum;
+      }
+    }
+    if (normal.dot (center.xyz) > 0)
+      normal = -normal;
+
+    supervoxel->normal_.normal_x = normal[0];
+    supervoxel->normal_.normal_y = normal[1];
+    supervoxel->normal_.normal_z = normal[2];
+    supervoxel->normal_.curvature = curvature;
+
+    supervoxel_clusters_arg[label] = supervoxel;
+  }
+
+  // Adjacency and labeled cloud straight from the lattice. Looking at the first four neighbours visits every connected pair once.
+  for (size_t pixel = 0; pixel < nr_pixels; ++pixel)
+  {
+    const uint32_t label = labels_[pixel];
+    for (int bit = 0; bit < 4; ++bit)
+    {
+      if (links_[pixel] & (1 << bit))
+      {
+        const uint32_t neighbour_label = labels_[pixel + neighbour_offsets_[bit]];
+        const std::pair<uint32_t, uint32_t> pair (std::min (label, neighbour_label), std::max (label, neighbour_label));
+        if (neighbour_label != label && (adjacency_.empty () || adjacency_.back () != pair))
+          adjacency_.push_back (pair);
+      }
+    }
+  }
+  std::sort (adjacency_.begin (), adjacency_.end ());
+  adjacency_.erase (std::unique (adjacency_.begin (), adjacency_.end ()), adjacency_.end ());
+
+  labeled_cloud_->resize (nr_pixels);
+  labeled_cloud_->width = input_->width;
+  labeled_cloud_->height = input_->height;
+  labeled_cloud_->is_dense = false;
+  Parallel::forRange (0, nr_pixels, nr_threads_, [&] (const size_t begin, const size_t end, const unsigned int)
+  {
+    for (size_t pixel = begin; pixel < end; ++pixel)
+    {
+      pcl::PointXYZL &point = labeled_cloud_->points[pixel];
+      point.x = input_->points[pixel].x;
+      point.y = input_->points[pixel].y;
+      point.z = input_->points[pixel].z;
+      point.label = labels_[pixel];
+    }
+  }, 4096);
+}
+
+template <typename PointT> void
+pcl::OrganizedSupervoxelClustering<PointT>::getSupervoxelAdjacency (std::multimap<uint32_t, uint32_t> &label_adjacency_arg) const
+{
+  label_adjacency_arg.clear ();
+  for (size_t pair_index = 0; pair_index < adjacency_.size (); ++pair_index)
+  {
+    label_adjacency_arg.insert (adjacency_[pair_index]);
+    label_adjacency_arg.insert (std::make_pair (adjacency_[pair_index].second, adjacency_[pair_index].first));
+  }
+}
+
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+///////////////// Protected Functions ////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+
+template <typename PointT> void
+pcl::OrganizedSupervoxelClustering<PointT>::computeConnectivity ()
+{
+  const int width = static_cast<int> (input_->width);
+  const int height = static_cast<int> (input_->height);
+  const int dx[8] = {1, 1, 0, -1, -1, -1, 0, 1};
+  const int dy[8] = {0, 1, 1, 1, 0, -1, -1, -1};
+
+  depths_.resize (input_->size ());
+  Parallel::forRange (0, input_->size (), nr_threads_, [&] (const size_t begin, const size_t end, const unsigned int)
+  {
+    for (size_t pixel = begin; pixel < end; ++pixel)
+      depths_[pixel] = isValid (input_->points[pixel]) ? input_->points[pixel].z : 0.0f;
+  }, 4096);
+
+  // Test the right, down-right, down and down-left links. With invalid depths at 0 the continuity test also rejects invalid neighbours.
+  forward_links_.resize (input_->size ());
+  Parallel::forRange (0, height, nr_threads_, [&] (const size_t begin, const size_t end, const unsigned int)
+  {
+    for (int row = static_cast<int> (begin); row < static_cast<int> (end); ++row)
+    {
+      for (int col = 0; col < width; ++col)
+      {
+        const size_t pixel = static_cast<size_t> (row) * width + col;
+        const float depth = depths_[pixel];
+        uint8_t links = 0;
+
+        for (int bit = 0; bit < 4; ++bit)
+        {
+          if (col + dx[bit] < 0 || col + dx[bit] >= width || row + dy[bit] >= height)
+            continue;
+
+          const float neighbour_depth = depths_[pixel + neighbour_offsets_[bit]];
+          if (std::fabs (depth - neighbour_depth) <= depth_discontinuity_ * std::min (depth, neighbour_depth) && neighbour_depth > 0)
+            links |= 1 << bit;
+        }
+        forward_links_[pixel] = links;
+      }
+    }
+  }, 8);
+
+  // The other four links are the forward links of the neighbours in the opposite direction
+  links_.resize (input_->size ());
+  Parallel::forRange (0, height, nr_threads_, [&] (const size_t begin, const size_t end, const unsigned int)
+  {
+    for (int row = static_cast<int> (begin); row < static_cast<int> (end); ++row)
+    {
+      for (int col = 0; col < width; ++col)
+      {
+        const size_t pixel = static_cast<size_t> (row) * width + col;
+        uint8_t links = forward_links_[pixel];
+
+        for (int bit = 4; bit < 8; ++bit)
+        {
+          if (col + dx[bit] >= 0 && col + dx[bit] < width && row + dy[bit] >= 0 && (forward_links_[pixel + neighbour_offsets_[bit]] & (1 << (bit - 4))))
+            links |= 1 << bit;
+        }
+        links_[pixel] = links;
+      }
+    }
+  }, 8);
+}
+
+template <typename PointT> void
+pcl::OrganizedSupervoxelClustering<PointT>::computePixelNormals ()
+{
+  pixel_normals_.resize (input_->size ());
+
+  if (input_normals_ && input_normals_->size () == input_->size ())
+  {
+    // Given normals only need to be checked and oriented like the estimated ones
+    Parallel::forRange (0, input_->size (), nr_threads_, [&] (const size_t begin, const size_t end, const unsigned int)
+    {
+      for (size_t pixel = begin; pixel < end; ++pixel)
+      {
+        Eigen::Vector3f &normal = pixel_normals_[pixel];
+        normal = input_normals_->points[pixel].getNormalVector3fMap ();
+
+        const float norm = normal.norm ();
+        if (depths_[pixel] == 0 || !pcl_isfinite (norm) || norm == 0)
+          normal.setZero ();
+        else if (normal.dot (input_->points[pixel].getVector3fMap ()) > 0)
+          normal /= -norm;
+        else
+          normal /= norm;
+      }
+    }, 4096);
+    return;
+  }
+
+  Parallel::forRange (0, input_->size (), nr_threads_, [&] (const size_t begin, const size_t end, const unsigned int)
+  {
+    for (size_t pixel = begin; pixel < end; ++pixel)
+    {
+      const uint8_t links = links_[pixel];
+      Eigen::Vector3f &normal = pixel_normals_[pixel];
+      normal.setZero ();
+
+      // Central differences where both neighbours are connected, one-sided otherwise
+      const size_t right = links & (1 << 0) ? pixel + neighbour_offsets_[0] : pixel;
+      const size_t left = links & (1 << 4) ? pixel + neighbour_offsets_[4] : pixel;
+      const size_t down = links & (1 << 2) ? pixel + neighbour_offsets_[2] : pixel;
+      const size_t up = links & (1 << 6) ? pixel + neighbour_offsets_[6] : pixel;
+      if (right == left || down == up)
+        continue;
+
+      const Eigen::Vector3f horizontal = input_->points[right].getVector3fMap () - input_->points[left].getVector3fMap ();
+      const Eigen::Vector3f vertical = input_->points[down].getVector3fMap () - input_->points[up].getVector3fMap ();
+      const Eigen::Vector3f cross = horizontal.cross (vertical);
+      const float norm = cross.norm ();
+      if (norm > 0)
+      {
+        normal = cross / norm;
+        if (normal.dot (input_->points[pixel].getVector3fMap ()) > 0)
+          normal = -normal;
+      }
+    }
+  }, 4096);
+}
+
+template <typename PointT> void
+pcl::OrganizedSupervoxelClustering<PointT>::computeCenters (const uint32_t nr_labels)
+{
+  ClusterSums zero;
+  zero.xyz.setZero ();
+  zero.rgb.setZero ();
+  zero.normal.setZero ();
+  zero.count = 0;
+  sums_.assign (nr_labels + 1, zero);
+  centers_.resize (nr_labels + 1);
+
+  for (size_t pixel = 0; pixel < labels_.size (); ++pixel)
+  {
+    if (labels_[pixel] == 0)
+      continue;
+
+    const PointT &point = input_->points[pixel];
+    ClusterSums &sums = sums_[labels_[pixel]];
+    sums.xyz += point.getVector3fMap ();
+    sums.rgb += Eigen::Vector3f (point.r, point.g, point.b);
+    sums.normal += pixel_normals_[pixel];
+    ++sums.count;
+  }
+
+  for (uint32_t label = 1; label <= nr_labels; ++label)
+  {
+    const ClusterSums &sums = sums_[label];
+    ClusterCenter &center = centers_[label];
+    if (sums.count == 0)
+      continue;
+
+    center.xyz = sums.xyz / sums.count;
+    center.rgb = sums.rgb / sums.count;
+    center.normal = sums.normal;
+    const float norm = center.normal.norm ();
+    if (norm > 0)
+      center.normal /= norm;
+  }
+}
+
+template <typename PointT> void
+pcl::OrganizedSupervoxelClustering<PointT>::assignPixels ()
+{
+  Parallel::forRange (0, labels_.size (), nr_threads_, [&] (const size_t begin, const size_t end, const unsigned int)
+  {
+    for (size_t pixel = begin; pixel < end; ++pixel)
+    {
+      const uint32_t label = labels_[pixel];
+      uint32_t best_label = label;
+
+      // Only pixels on a cluster border have anywhere to go. The candidates are the clusters of the 4 direct neighbours.
+      const uint8_t links = links_[pixel];
+      bool border = false;
+      for (int bit = 0; bit < 8 && !border; bit += 2)
+        border = (links & (1 << bit)) && labels_[pixel + neighbour_offsets_[bit]] != label;
+
+      if (border)
+      {
+        float best_distance = distance (pixel, centers_[label]);
+        uint32_t tried[4];
+        int nr_tried = 0;
+        for (int bit = 0; bit < 8; bit += 2)
+        {
+          if (!(links & (1 << bit)))
+            continue;
+
+          const uint32_t candidate = labels_[pixel + neighbour_offsets_[bit]];
+          if (candidate == label || std::find (tried, tried + nr_tried, candidate) != tried + nr_tried)
+            continue;
+          tried[nr_tried++] = candidate;
+
+          const float candidate_distance = distance (pixel, centers_[candidate]);
+          if (candidate_distance < best_distance)
+          {
+            best_distance = candidate_distance;
+            best_label = candidate;
+          }
+        }
+      }
+      next_labels_[pixel] = best_label;
+    }
+  }, 4096);
+
+  labels_.swap (next_labels_);
+}
+
+template <typename PointT> uint32_t
+pcl::OrganizedSupervoxelClustering<PointT>::enforceConnectivity ()
+{
+  const size_t min_size = seed_step_ * seed_step_ / 4;
+  const int connected_bits[4] = {0, 2, 4, 6};
+  uint32_t nr_supervoxels = 0;
+
+  std::fill (next_labels_.begin (), next_labels_.end (), 0);
+  for (size_t seed = 0; seed < labels_.size (); ++seed)
+  {
+    if (labels_[seed] == 0 || next_labels_[seed] != 0)
+      continue;
+
+    // Grow the 4-connected component of the seed's cluster
+    const uint32_t label = ++nr_supervoxels;
+    component_.clear ();
+    component_.push_back (static_cast<uint32_t> (seed));
+    next_labels_[seed] = label;
+    for (size_t member = 0; member < component_.size (); ++member)
+    {
+      const size_t pixel = component_[member];
+      for (int bit_index = 0; bit_index < 4; ++bit_index)
+      {
+        const int bit = connected_bits[bit_index];
+        const size_t neighbour = pixel + neighbour_offsets_[bit];
+        if ((links_[pixel] & (1 << bit)) && next_labels_[neighbour] == 0 && labels_[neighbour] == labels_[seed])
+        {
+          next_labels_[neighbour] = label;
+          component_.push_back (static_cast<uint32_t> (neighbour));
+        }
+      }
+    }
+
+    if (component_.size () >= min_size)
+      continue;
+
+    // Fragments join a component that is already finished. Without one they stay a supervoxel of their own.
+    uint32_t adjacent_label = 0;
+    for (size_t member = 0; member < component_.size () && adjacent_label == 0; ++member)
+    {
+      const size_t pixel = component_[member];
+      for (int bit_index = 0; bit_index < 4; ++bit_index)
+      {
+        const int bit = connected_bits[bit_index];
+        if (!(links_[pixel] & (1 << bit)))
+          continue;
+
+        const uint32_t neighbour_label = next_labels_[pixel + neighbour_offsets_[bit]];
+        if (neighbour_label != 0 && neighbour_label != label)
+        {
+          adjacent_label = neighbour_label;
+          break;
+        }
+      }
+    }
+
+    if (adjacent_label != 0)
+    {
+      for (size_t member = 0; member < component_.size (); ++member)
+        next_labels_[component_[member]] = adjacent_label;
+      --nr_supervoxels;
+    }
+  }
+
+  labels_.swap (next_labels_);
+  return (nr_supervoxels);
+}
+
+template <typename PointT> float
+pcl::OrganizedSupervoxelClustering<PointT>::distance (const size_t pixel_arg,
+                                                      const ClusterCenter &center_arg) const
+{
+  const PointT &point = input_->points[pixel_arg];
+  const float spatial_weight = spatial_importance_ / seed_resolution_;
+  const float normal_difference = 1.0f - std::fabs (pixel_normals_[pixel_arg].dot (center_arg.normal));
+  float distance = spatial_weight * spatial_weight * (point.getVector3fMap () - center_arg.xyz).squaredNorm ()
+                   + normal_importance_ * normal_importance_ * normal_difference * normal_difference;
+
+  if (color_importance_ > 0)
+  {
+    const float color_weight = color_importance_ / 255.0f;
+    distance += color_weight * color_weight * (Eigen::Vector3f (point.r, point.g, point.b) - center_arg.rgb).squaredNorm ();
+  }
+
+  return (distance);
+}
+
+#endif // PCL_SEGMENTATION_IMPL_ORGANIZED_SUPERVOXEL_CLUSTERING_HPP_
@@ -589,6 +589,16 @@ void MainController::run()
 
         gui->totalFernDefs->operator=(strs6.str());
 
+        std::stringstream strs7;
+        strs7 << eFusion->getSegmentationScheduler().getSegmented();
+
+        gui->segmentedFrames->operator=(strs7.str());
+
+        std::stringstream strs8;
+        strs8 << eFusion->getSegmentationScheduler().getPropagated();
+
+        gui->propagatedFrames->operator=(strs8.str());
+
         gui->postCall();
 
         logReader->flipColors = gui->flipColors->Get();
@@ -626,6 +636,11 @@ void MainController::run()
             eFusion->savePly();
         }
 
+        if(pangolin::Pushed(*gui->reloadObjects))
+        {
+            eFusion->reloadObjects();
+        }
+
         TOCK("GUI");
     }
 }
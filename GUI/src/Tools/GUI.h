@@ -116,6 +116,7 @@ class GUI
             pause = new pangolin::Var<bool>("ui.Pause", false, true);
             step = new pangolin::Var<bool>("ui.Step", false, false);
             save = new pangolin::Var<bool>("ui.Save", false, false);
+            reloadObjects = new pangolin::Var<bool>("ui.Reload objects", false, false);
             reset = new pangolin::Var<bool>("ui.Reset", false, false);
             flipColors = new pangolin::Var<bool>("ui.Flip RGB", false, true);
 
@@ -164,6 +165,8 @@ drawSeg = new pangolin::Var<bool>("ui.Draw Seg", showcaseMode, true);
             totalFerns = new pangolin::Var<std::string>("ui.Total ferns", "0");
             totalDefs = new pangolin::Var<std::string>("ui.Total deforms", "0");
             totalFernDefs = new pangolin::Var<std::string>("ui.Total fern deforms", "0");
+            segmentedFrames = new pangolin::Var<std::string>("ui.Segmented frames", "0");
+            propagatedFrames = new pangolin::Var<std::string>("ui.Propagated frames", "0");
 
             trackInliers = new pangolin::Var<std::string>("ui.Inliers", "0");
             trackRes = new pangolin::Var<std::string>("ui.Residual", "0");
@@ -189,6 +192,7 @@ drawSeg = new pangolin::Var<bool>("ui.Draw Seg", showcaseMode, true);
             }
             delete step;
             delete save;
+            delete reloadObjects;
             delete trackInliers;
             delete trackRes;
             delete confidenceThreshold;
@@ -206,6 +210,8 @@ drawSeg = new pangolin::Var<bool>("ui.Draw Seg", showcaseMode, true);
             delete pyramid;
             delete rgbOnly;
             delete totalFernDefs;
+            delete segmentedFrames;
+            delete propagatedFrames;
             delete drawFerns;
             delete followPose;
             delete drawDeforms;
@@ -397,6 +403,7 @@ drawSeg = new pangolin::Var<bool>("ui.Draw Seg", showcaseMode, true);
         pangolin::Var<bool> * pause,
                             * step,
                             * save,
+                            * reloadObjects,
                             * reset,
                             * flipColors,
                             * rgbOnly,
@@ -428,6 +435,8 @@ drawSeg = new pangolin::Var<bool>("ui.Draw Seg", showcaseMode, true);
                                    * totalFerns,
                                    * totalDefs,
                                    * totalFernDefs,
+                                   * segmentedFrames,
+                                   * propagatedFrames,
                                    * trackInliers,
                                    * trackRes,
                                    * logProgress;
@@ -0,0 +1,566 @@
+/*
+ * This file is part of ElasticFusion.
+ *
+ * Copyright (C) 2015 Imperial College London
+ *
+ * The use of the code within this file and all code within files that
+ * make up the software that is ElasticFusion is permitted for
+ * non-commercial purposes only.  The full terms and conditions that
+ * apply to the code within this file are detailed within the LICENSE.txt
+ * file and at <http://www.imperial.ac.uk/dyson-robotics-lab/downloads/elastic-fusion/elastic-fusion-license/>
+ * unless explicitly stated.  By downloading this file you agree to
+ * comply with these terms.
+ *
+ * If you wish to use any of this code for commercial purposes then
+ * please email researchcontracts.engineering@imperial.ac.uk.
+ *
+ */
+
+#include <lccp.hpp>
+#include <organized_supervoxel_clustering.hpp>
+#include <Utils/LabelPyramid.h>
+#include <SurfelSegments.h>
+#include <SegmentBoxes.h>
+
+#include <pcl/io/ply_io.h>
+#include <pcl/features/moment_of_inertia_estimation.h>
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <cstring>
+#include <string>
+
+//Counts every heap allocation so per frame allocations can be reported
+std::atomic<size_t> numAllocations(0);
+
+void * operator new(size_t size)
+{
+    numAllocations++;
+
+    void * ptr = std::malloc(size ? size : 1);
+
+    if(!ptr)
+    {
+        throw std::bad_alloc();
+    }
+
+    return ptr;
+}
+
+void operator delete(void * ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void * ptr, size_t) noexcept
+{
+    std::free(ptr);
+}
+
+typedef pcl::PointXYZRGB PointT;
+
+//Exposes the edge classification stages of LCCPSegmentation
+class BenchSegmentation : public pcl::LCCPSegmentation<PointT>
+{
+    public:
+        void classify()
+        {
+            calculateConvexConnections();
+        }
+
+        size_t numEdges() const
+        {
+            return edge_properties_.size();
+        }
+
+        bool isConvex(const size_t edge) const
+        {
+            return edge_properties_.at(edge).is_convex;
+        }
+
+        float normalDifference(const size_t edge) const
+        {
+            return edge_properties_.at(edge).normal_difference;
+        }
+};
+
+//A bumpy surface sampled on a grid, every supervoxel is connected to its 8 neighbours
+void makeScene(const int side,
+               std::map<uint32_t, pcl::Supervoxel<PointT>::Ptr> & supervoxels,
+               std::multimap<uint32_t, uint32_t> & adjacency)
+{
+    const float spacing = 0.03f;
+
+    for(int row = 0; row < side; row++)
+    {
+        for(int col = 0; col < side; col++)
+        {
+            const float x = col * spacing;
+            const float y = row * spacing;
+            const float noise = (std::rand() / (float)RAND_MAX - 0.5f) * 0.2f;
+
+            pcl::Supervoxel<PointT>::Ptr sv(new pcl::Supervoxel<PointT>);
+            sv->centroid_.x = x;
+            sv->centroid_.y = y;
+            sv->centroid_.z = 0.05f * std::sin(x * 10.0f) * std::cos(y * 7.0f);
+            sv->normal_.normal_x = -0.5f * std::cos(x * 10.0f) * std::cos(y * 7.0f) + noise;
+            sv->normal_.normal_y = 0.35f * std::sin(x * 10.0f) * std::sin(y * 7.0f) - noise;
+            sv->normal_.normal_z = 1.0f;
+
+            supervoxels[row * side + col + 1] = sv;
+        }
+    }
+
+    for(int row = 0; row < side; row++)
+    {
+        for(int col = 0; col < side; col++)
+        {
+            for(int dr = -1; dr <= 1; dr++)
+            {
+                for(int dc = -1; dc <= 1; dc++)
+                {
+                    if((dr == 0 && dc == 0) || row + dr < 0 || row + dr >= side || col + dc < 0 || col + dc >= side)
+                    {
+                        continue;
+                    }
+
+                    adjacency.insert(std::make_pair(row * side + col + 1, (row + dr) * side + col + dc + 1));
+                }
+            }
+        }
+    }
+}
+
+//A 640x480 depth frame of a floor, a wall, a ball and a box, with a fifth of the pixels missing, and its exact normals
+pcl::PointCloud<PointT>::Ptr makeFrame(pcl::PointCloud<pcl::Normal> & normals)
+{
+    const int width = 640;
+    const int height = 480;
+    const float focal = 525.0f;
+
+    pcl::PointCloud<PointT>::Ptr frame(new pcl::PointCloud<PointT>);
+    frame->width = width;
+    frame->height = height;
+    frame->resize(width * height);
+    normals.width = width;
+    normals.height = height;
+    normals.resize(width * height);
+
+    const Eigen::Vector3f ballCenter(0.0f, 0.2f, 1.5f);
+    const float ballRadius = 0.3f;
+
+    for(int row = 0; row < height; row++)
+    {
+        for(int col = 0; col < width; col++)
+        {
+            const Eigen::Vector3f ray((col - width / 2) / focal, (row - height / 2) / focal, 1.0f);
+
+            //Wall at z = 3, floor at y = 0.5
+            float depth = 3.0f;
+            int surface = 1;
+
+            if(ray(1) > 0 && 0.5f / ray(1) < depth)
+            {
+                depth = 0.5f / ray(1);
+                surface = 2;
+            }
+
+            const float b = ray.dot(ballCenter);
+            const float discriminant = b * b - ray.squaredNorm() * (ballCenter.squaredNorm() - ballRadius * ballRadius);
+
+            if(discriminant > 0 && (b - std::sqrt(discriminant)) / ray.squaredNorm() < depth)
+            {
+                depth = (b - std::sqrt(discriminant)) / ray.squaredNorm();
+                surface = 3;
+            }
+
+            const Eigen::Vector3f boxPoint = ray * 1.2f;
+
+            if(boxPoint(0) > -0.8f && boxPoint(0) < -0.4f && boxPoint(1) > 0.1f && boxPoint(1) < 0.5f && 1.2f < depth)
+            {
+                depth = 1.2f;
+                surface = 4;
+            }
+
+            PointT & point = frame->points[row * width + col];
+            pcl::Normal & normal = normals.points[row * width + col];
+
+            if(std::rand() % 5 == 0)
+            {
+                point.x = point.y = point.z = 0;
+                point.r = point.g = point.b = 0;
+                normal.getNormalVector3fMap().setZero();
+                continue;
+            }
+
+            point.x = ray(0) * depth;
+            point.y = ray(1) * depth;
+            point.z = depth;
+
+            if(surface == 2)
+            {
+                normal.getNormalVector3fMap() = Eigen::Vector3f(0, -1, 0);
+            }
+            else if(surface == 3)
+            {
+                normal.getNormalVector3fMap() = (point.getVector3fMap() - ballCenter).normalized();
+            }
+            else
+            {
+                normal.getNormalVector3fMap() = Eigen::Vector3f(0, 0, -1);
+            }
+
+            point.r = surface * 50;
+            point.g = 100;
+            point.b = 255 - surface * 40;
+        }
+    }
+
+    return frame;
+}
+
+//Organized supervoxels, LCCP and the label image, as myLccp runs them for every frame
+void timeOrganizedFrame(pcl::PointCloud<PointT>::Ptr frame,
+                        pcl::PointCloud<pcl::Normal>::Ptr normals,
+                        const int frames,
+                        const std::string & name)
+{
+    pcl::OrganizedSupervoxelClustering<PointT> organized(0.03f);
+    pcl::LCCPSegmentation<PointT> lccp;
+    std::vector<float> labelImage(frame->size());
+    std::map<uint32_t, pcl::Supervoxel<PointT>::Ptr> clusters;
+    std::multimap<uint32_t, uint32_t> clusterAdjacency;
+    double extractTime = 0;
+    double segmentTime = 0;
+
+    for(int i = 0; i <= frames; i++)
+    {
+        std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+
+        organized.setInputCloud(frame);
+        organized.setNormalCloud(normals);
+        organized.extract(clusters);
+        organized.getSupervoxelAdjacency(clusterAdjacency);
+
+        std::chrono::high_resolution_clock::time_point extracted = std::chrono::high_resolution_clock::now();
+
+        lccp.setConcavityToleranceThreshold(10);
+        lccp.setSanityCheck(true);
+        lccp.setSmoothnessCheck(true, 0.01f, 0.03f, 0.1f);
+        lccp.setMinSegmentSize(5);
+        lccp.setInputSupervoxels(clusters, clusterAdjacency);
+        lccp.segment();
+        lccp.relabelCloud(*organized.getLabeledCloud(), labelImage.data());
+
+        std::chrono::high_resolution_clock::time_point end = std::chrono::high_resolution_clock::now();
+
+        //First frame sizes the buffers
+        if(i > 0)
+        {
+            extractTime += std::chrono::duration<double, std::milli>(extracted - start).count();
+            segmentTime += std::chrono::duration<double, std::milli>(end - extracted).count();
+        }
+    }
+
+    std::cout << name << clusters.size() << " supervoxels, extraction " << std::setprecision(2) << extractTime / frames
+              << "ms, LCCP " << segmentTime / frames << "ms" << std::endl;
+}
+
+//Supervoxels and LCCP on pyramid level 0 to 2, labels upsampled back and compared with level 0
+void timePyramid(pcl::PointCloud<PointT>::Ptr frame,
+                 pcl::PointCloud<pcl::Normal>::Ptr normals,
+                 const int frames)
+{
+    std::vector<float> reference;
+
+    for(int level = 0; level <= 2; level++)
+    {
+        pcl::OrganizedSupervoxelClustering<PointT> organized(0.03f, 16 >> level);
+        pcl::LCCPSegmentation<PointT> lccp;
+        pcl::PointCloud<PointT>::Ptr coarse(new pcl::PointCloud<PointT>);
+        pcl::PointCloud<pcl::Normal>::Ptr coarseNormals(new pcl::PointCloud<pcl::Normal>);
+        std::vector<float> coarseLabels;
+        std::vector<float> labelImage(frame->size());
+        std::map<uint32_t, pcl::Supervoxel<PointT>::Ptr> clusters;
+        std::multimap<uint32_t, uint32_t> clusterAdjacency;
+        double time = 0;
+
+        for(int i = 0; i <= frames; i++)
+        {
+            std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+
+            if(level > 0)
+            {
+                LabelPyramid::downsample(*frame, normals, level, *coarse, *coarseNormals);
+            }
+            else
+            {
+                coarse = frame;
+                coarseNormals = normals;
+            }
+
+            organized.setInputCloud(coarse);
+            organized.setNormalCloud(coarseNormals);
+            organized.extract(clusters);
+            organized.getSupervoxelAdjacency(clusterAdjacency);
+
+            lccp.setConcavityToleranceThreshold(10);
+            lccp.setSanityCheck(true);
+            lccp.setSmoothnessCheck(true, 0.01f, 0.03f, 0.1f);
+            lccp.setMinSegmentSize(5);
+            lccp.setInputSupervoxels(clusters, clusterAdjacency);
+            lccp.segment();
+
+            coarseLabels.resize(coarse->size());
+            lccp.relabelCloud(*organized.getLabeledCloud(), coarseLabels.data());
+
+            if(level > 0)
+            {
+                LabelPyramid::upsample(*frame, *coarse, coarseLabels.data(), level, labelImage.data());
+            }
+            else
+            {
+                labelImage = coarseLabels;
+            }
+
+            std::chrono::high_resolution_clock::time_point end = std::chrono::high_resolution_clock::now();
+
+            if(i > 0)
+            {
+                time += std::chrono::duration<double, std::milli>(end - start).count();
+            }
+        }
+
+        if(level == 0)
+        {
+            reference = labelImage;
+        }
+
+        std::cout << "Pyramid level " << level << ": " << coarse->width << "x" << coarse->height << ", " << clusters.size() << " supervoxels, "
+                  << std::setprecision(2) << time / frames << "ms, label agreement with level 0 "
+                  << std::setprecision(3) << LabelPyramid::agreement(reference.data(), labelImage.data(), labelImage.size()) << std::endl;
+    }
+}
+
+double timeClassification(BenchSegmentation & lccp, const bool vectorized, const int iterations)
+{
+    lccp.setVectorizedConvexity(vectorized);
+    lccp.classify();
+
+    std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+
+    for(int i = 0; i < iterations; i++)
+    {
+        lccp.classify();
+    }
+
+    std::chrono::high_resolution_clock::time_point end = std::chrono::high_resolution_clock::now();
+
+    return std::chrono::duration<double, std::milli>(end - start).count() / iterations;
+}
+
+//Segments frames alternating between two scenes, either with a fresh context every frame or one reused context
+double allocationsPerFrame(const std::map<uint32_t, pcl::Supervoxel<PointT>::Ptr> * supervoxels,
+                           const std::multimap<uint32_t, uint32_t> * adjacency,
+                           const bool reuse,
+                           const int frames)
+{
+    pcl::LCCPSegmentation<PointT> persistent;
+    size_t total = 0;
+
+    //First frames only size the reused storage
+    const int warmup = 2;
+
+    for(int i = 0; i < warmup + frames; i++)
+    {
+        const size_t before = numAllocations;
+
+        {
+            pcl::LCCPSegmentation<PointT> fresh;
+            pcl::LCCPSegmentation<PointT> & lccp = reuse ? persistent : fresh;
+
+            lccp.setConcavityToleranceThreshold(10);
+            lccp.setSanityCheck(true);
+            lccp.setSmoothnessCheck(true, 0.01f, 0.03f, 0.1f);
+            lccp.setKFactor(1);
+            lccp.setMinSegmentSize(3);
+            lccp.setInputSupervoxels(supervoxels[i % 2], adjacency[i % 2]);
+            lccp.segment();
+        }
+
+        if(i >= warmup)
+        {
+            total += numAllocations - before;
+        }
+    }
+
+    return total / (double)frames;
+}
+
+//Boxes of saved segment clouds from SegmentBoxes against pcl::MomentOfInertiaEstimation
+int compareBoxes(const int numFiles, char * files[])
+{
+    pcl::PointCloud<pcl::PointXYZLNormal> cloud;
+    std::vector<Eigen::Vector4f> surfels;
+    SurfelSegments segments;
+    SegmentBoxes boxes;
+
+    float maxPositionError = 0;
+    float maxExtentError = 0;
+    float maxAxisError = 0;
+    int failures = 0;
+    const float maxError = 1e-3f;
+    double time = 0;
+    double pclTime = 0;
+
+    for(int f = 0; f < numFiles; f++)
+    {
+        if(pcl::io::loadPLYFile(files[f], cloud) < 0 || cloud.empty())
+        {
+            std::cout << "Could not read " << files[f] << std::endl;
+            continue;
+        }
+
+        //Same layout as the downloaded map, every file is one segment
+        surfels.resize(cloud.size() * 3);
+
+        for(size_t i = 0; i < cloud.size(); i++)
+        {
+            surfels[i * 3] = Eigen::Vector4f(cloud.points[i].x, cloud.points[i].y, cloud.points[i].z, 1);
+            surfels[i * 3 + 1] = Eigen::Vector4f(0, 1, 0, 0);
+            surfels[i * 3 + 2] = Eigen::Vector4f(cloud.points[i].normal_x, cloud.points[i].normal_y, cloud.points[i].normal_z, 0);
+        }
+
+        std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+
+        segments.extract(surfels.data(), cloud.size());
+        boxes.compute(segments);
+
+        std::chrono::high_resolution_clock::time_point end = std::chrono::high_resolution_clock::now();
+        time += std::chrono::duration<double, std::milli>(end - start).count();
+
+        pcl::PointXYZLNormal minPoint, maxPoint, position;
+        Eigen::Matrix3f rotation;
+
+        start = std::chrono::high_resolution_clock::now();
+
+        pcl::MomentOfInertiaEstimation<pcl::PointXYZLNormal> featureExtractor;
+        featureExtractor.setInputCloud(cloud.makeShared());
+        featureExtractor.compute();
+        featureExtractor.getOBB(minPoint, maxPoint, position, rotation);
+
+        end = std::chrono::high_resolution_clock::now();
+        pclTime += std::chrono::duration<double, std::milli>(end - start).count();
+
+        const SegmentBoxes::Box & box = boxes.box(0);
+
+        //Axes have to agree in sign as well, the slice descriptors depend on it
+        const float positionError = (box.position - position.getVector3fMap()).norm();
+        const float extentError = std::max((box.min - minPoint.getVector3fMap()).norm(), (box.max - maxPoint.getVector3fMap()).norm());
+        const Eigen::Vector3f alignment = (box.rotation.transpose() * rotation).diagonal();
+        const float axisError = 1.0f - alignment.minCoeff();
+        const int signFlips = (alignment.array() < 0).count();
+
+        std::cout << files[f] << ": " << cloud.size() << " points, position error " << positionError
+                  << ", extent error " << extentError << ", axis error " << axisError << ", flipped axes " << signFlips << std::endl;
+
+        //Nearly equal eigenvalues leave the axes themselves ambiguous, only then may they differ
+        failures += positionError > maxError || extentError > maxError || axisError > maxError;
+
+        maxPositionError = std::max(maxPositionError, positionError);
+        maxExtentError = std::max(maxExtentError, extentError);
+        maxAxisError = std::max(maxAxisError, axisError);
+    }
+
+    std::cout << "Max position error " << maxPositionError << ", max extent error " << maxExtentError << ", max axis error " << maxAxisError << std::endl;
+    std::cout << "Boxes differing by more than " << maxError << ": " << failures << std::endl;
+    std::cout << std::fixed << std::setprecision(2) << "SegmentBoxes: " << time << "ms, MomentOfInertiaEstimation: " << pclTime << "ms" << std::endl;
+
+    return failures == 0 ? 0 : 1;
+}
+
+int main(int argc, char * argv[])
+{
+    if(argc > 1 && std::strcmp(argv[1], "--obb") == 0)
+    {
+        return compareBoxes(argc - 2, argv + 2);
+    }
+
+    const int side = argc > 1 ? std::atoi(argv[1]) : 64;
+    const int iterations = argc > 2 ? std::atoi(argv[2]) : 200;
+
+    std::srand(0);
+
+    std::map<uint32_t, pcl::Supervoxel<PointT>::Ptr> supervoxels;
+    std::multimap<uint32_t, uint32_t> adjacency;
+    makeScene(side, supervoxels, adjacency);
+
+    BenchSegmentation lccp;
+    lccp.setConcavityToleranceThreshold(10);
+    lccp.setSanityCheck(true);
+    lccp.setSmoothnessCheck(true, 0.01f, 0.03f, 0.1f);
+    lccp.setInputSupervoxels(supervoxels, adjacency);
+
+    const double scalarTime = timeClassification(lccp, false, iterations);
+
+    std::vector<bool> scalarConvex(lccp.numEdges());
+    std::vector<float> scalarAngle(lccp.numEdges());
+
+    for(size_t i = 0; i < lccp.numEdges(); i++)
+    {
+        scalarConvex[i] = lccp.isConvex(i);
+        scalarAngle[i] = lccp.normalDifference(i);
+    }
+
+    const double vectorTime = timeClassification(lccp, true, iterations);
+
+    size_t mismatches = 0;
+    size_t numConvex = 0;
+    float maxAngleError = 0;
+
+    for(size_t i = 0; i < lccp.numEdges(); i++)
+    {
+        mismatches += scalarConvex[i] != lccp.isConvex(i);
+        numConvex += scalarConvex[i];
+        maxAngleError = std::max(maxAngleError, std::fabs(scalarAngle[i] - lccp.normalDifference(i)));
+    }
+
+    std::cout << "Supervoxels: " << supervoxels.size() << ", edges: " << lccp.numEdges() << ", convex: " << numConvex << std::endl;
+    std::cout << std::fixed << std::setprecision(4);
+    std::cout << "Scalar:     " << scalarTime << "ms" << std::endl;
+#if defined(__AVX__)
+    std::cout << "Lanes: 8 (AVX)" << std::endl;
+#elif defined(__SSE2__)
+    std::cout << "Lanes: 4 (SSE2)" << std::endl;
+#else
+    std::cout << "Lanes: 1 (scalar)" << std::endl;
+#endif
+    std::cout << "Vectorized: " << vectorTime << "ms (" << std::setprecision(2) << scalarTime / vectorTime << "x)" << std::endl;
+    std::cout << "Classification mismatches: " << mismatches << ", max normal difference error: " << std::setprecision(6) << maxAngleError << " deg" << std::endl;
+
+    std::map<uint32_t, pcl::Supervoxel<PointT>::Ptr> frameSupervoxels[2];
+    std::multimap<uint32_t, uint32_t> frameAdjacency[2];
+    makeScene(side, frameSupervoxels[0], frameAdjacency[0]);
+    makeScene(side - side / 8, frameSupervoxels[1], frameAdjacency[1]);
+
+    const int frames = 20;
+
+    std::cout << "Allocations per frame, fresh context: " << std::setprecision(1) << allocationsPerFrame(frameSupervoxels, frameAdjacency, false, frames)
+              << ", reused context: " << allocationsPerFrame(frameSupervoxels, frameAdjacency, true, frames) << std::endl;
+
+    //Whole per-frame path on a depth frame, with normals estimated from the pixel grid and with given normals as they come from the GPU
+    pcl::PointCloud<pcl::Normal>::Ptr frameNormals(new pcl::PointCloud<pcl::Normal>);
+    pcl::PointCloud<PointT>::Ptr frame = makeFrame(*frameNormals);
+
+    timeOrganizedFrame(frame, pcl::PointCloud<pcl::Normal>::Ptr(), frames, "Organized frame, estimated normals: ");
+    timeOrganizedFrame(frame, frameNormals, frames, "Organized frame, given normals:     ");
+
+    timePyramid(frame, frameNormals, frames);
+
+    return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,190 @@
+/*
+ * This file is part of ElasticFusion.
+ *
+ * Copyright (C) 2015 Imperial College London
+ * 
+ * The use of the code within this file and all code within files that 
+ * make up the software that is ElasticFusion is permitted for 
+ * non-commercial purposes only.  The full terms and conditions that 
+ * apply to the code within this file are detailed within the LICENSE.txt 
+ * file and at <http://www.imperial.ac.uk/dyson-robotics-lab/downloads/elastic-fusion/elastic-fusion-license/> 
+ * unless explicitly stated.  By downloading this file you agree to 
+ * comply with these terms.
+ *
+ * If you wish to use any of this code for commercial purposes then 
+ * please email researchcontracts.engineering@imperial.ac.uk.
+ *
+ */
+
+#include <DescriptorMatcher.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+static const int width = DescriptorMatcher::width;
+static const int numCuts = 5;
+static const float tolerance = 15.0f;
+static const int minScore = 5;
+
+float randomAngle()
+{
+    return std::rand() / (float)RAND_MAX * 180.0f;
+}
+
+//Every segment is a noisy copy of a random template in some of its cuts and unrelated elsewhere
+void makeDescriptors(const std::vector<float> & templates, const size_t numSegments, std::vector<float> & descriptors)
+{
+    const size_t numTemplates = templates.size() / width;
+
+    descriptors.resize(numSegments * numCuts * width);
+
+    for(size_t segment = 0; segment < numSegments; segment++)
+    {
+        const size_t t = std::rand() % numTemplates;
+
+        for(int cut = 0; cut < numCuts; cut++)
+        {
+            const bool copy = std::rand() % 2 == 0;
+
+            for(int j = 0; j < width; j++)
+            {
+                const float noise = (std::rand() / (float)RAND_MAX - 0.5f) * 40.0f;
+
+                descriptors[(segment * numCuts + cut) * width + j] = copy ? templates[t * width + j] + noise : randomAngle();
+            }
+        }
+    }
+}
+
+//The per segment loop recognition used for its single template, run over every template
+void referenceMatch(const std::vector<float> & templates,
+                    const std::vector<float> & descriptors,
+                    const int k,
+                    std::vector<DescriptorMatcher::Match> & results)
+{
+    const size_t numTemplates = templates.size() / width;
+    const size_t numSegments = descriptors.size() / (numCuts * width);
+
+    results.clear();
+
+    for(size_t segment = 0; segment < numSegments; segment++)
+    {
+        std::vector<DescriptorMatcher::Match> scores;
+
+        for(size_t t = 0; t < numTemplates; t++)
+        {
+            int count = 0;
+            int tempCount = 0;
+
+            for(int j = 0; j < numCuts * width; j++)
+            {
+                const float value = descriptors[segment * numCuts * width + j];
+
+                if(value > templates[t * width + j % width] - tolerance && value < templates[t * width + j % width] + tolerance)
+                {
+                    tempCount++;
+                }
+
+                if((j + 1) % width == 0)
+                {
+                    count = std::max(count, tempCount);
+                    tempCount = 0;
+                }
+            }
+
+            if(count >= minScore)
+            {
+                const DescriptorMatcher::Match match = {(int)t, count};
+                scores.push_back(match);
+            }
+        }
+
+        std::stable_sort(scores.begin(), scores.end(), [](const DescriptorMatcher::Match & a, const DescriptorMatcher::Match & b)
+        {
+            return a.score > b.score;
+        });
+
+        for(int i = 0; i < k; i++)
+        {
+            const DescriptorMatcher::Match none = {-1, 0};
+            results.push_back(i < (int)scores.size() ? scores[i] : none);
+        }
+    }
+}
+
+int main(int argc, char * argv[])
+{
+    const int iterations = argc > 1 ? std::atoi(argv[1]) : 20;
+    const int k = 3;
+
+    const int templateCounts[] = {1, 8, 32, 128, 512};
+    const int segmentCounts[] = {50, 200, 1000};
+
+    std::srand(0);
+
+    DescriptorMatcher matcher(tolerance, minScore);
+    std::vector<DescriptorMatcher::Match> reference;
+    size_t mismatches = 0;
+
+    std::cout << std::fixed;
+
+    for(const int numTemplates : templateCounts)
+    {
+        std::vector<float> templates(numTemplates * width);
+        std::generate(templates.begin(), templates.end(), randomAngle);
+
+        matcher.setTemplates(templates.data(), numTemplates);
+
+        for(const int numSegments : segmentCounts)
+        {
+            std::vector<float> descriptors;
+            makeDescriptors(templates, numSegments, descriptors);
+
+            std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+
+            for(int i = 0; i < iterations; i++)
+            {
+                referenceMatch(templates, descriptors, k, reference);
+            }
+
+            std::chrono::high_resolution_clock::time_point end = std::chrono::high_resolution_clock::now();
+            const double referenceTime = std::chrono::duration<double, std::milli>(end - start).count() / iterations;
+
+            start = std::chrono::high_resolution_clock::now();
+
+            for(int i = 0; i < iterations; i++)
+            {
+                matcher.match(descriptors.data(), numSegments, numCuts * width, k);
+            }
+
+            end = std::chrono::high_resolution_clock::now();
+            const double matcherTime = std::chrono::duration<double, std::milli>(end - start).count() / iterations;
+
+            size_t recognised = 0;
+
+            for(int segment = 0; segment < numSegments; segment++)
+            {
+                recognised += matcher.matches(segment)[0].object >= 0;
+
+                for(int i = 0; i < k; i++)
+                {
+                    mismatches += matcher.matches(segment)[i].object != reference[segment * k + i].object ||
+                                  matcher.matches(segment)[i].score != reference[segment * k + i].score;
+                }
+            }
+
+            std::cout << std::setw(4) << numTemplates << " templates, " << std::setw(4) << numSegments << " segments: "
+                      << std::setprecision(3) << "scalar " << std::setw(8) << referenceTime << "ms, matcher " << std::setw(8) << matcherTime << "ms ("
+                      << std::setprecision(1) << referenceTime / matcherTime << "x), recognised " << recognised << std::endl;
+        }
+    }
+
+    std::cout << "Top " << k << " mismatches against the scalar loop: " << mismatches << std::endl;
+
+    return mismatches == 0 ? 0 : 1;
+}